@@ -0,0 +1,187 @@
+// Сравнение разбора JSON в куче и в арене: число выделений памяти,
+// время разбора и время освобождения документа. Для ленивого документа
+// дополнительно измеряется чтение полей name из base_requests, для сравнения -
+// разбор по схеме запросов (RequestsDecoder) без построения дерева.
+//
+// Сборка из корня репозитория:
+//   g++ -std=c++17 -O2 -I. benchmarks/json_load_benchmark.cpp json.cpp json_lazy.cpp requests_decoder.cpp -o json_load_benchmark
+// Запуск: ./json_load_benchmark [input.json]
+// Без аргумента разбирается сгенерированный документ с base_requests.
+
+#include "json.h"
+#include "json_lazy.h"
+#include "requests_decoder.h"
+
+#include <chrono>
+#include <fstream>
+#include <memory_resource>
+#include <optional>
+#include <sstream>
+#include <string>
+
+namespace {
+
+// Пропускает запросы к upstream, подсчитывая их число и объём
+class CountingResource : public std::pmr::memory_resource {
+public:
+    explicit CountingResource(std::pmr::memory_resource* upstream)
+        : upstream_(upstream) {
+    }
+
+    size_t GetAllocations() const {
+        return allocations_;
+    }
+
+    size_t GetBytes() const {
+        return bytes_;
+    }
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        ++allocations_;
+        bytes_ += bytes;
+        return upstream_->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override {
+        upstream_->deallocate(ptr, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+private:
+    std::pmr::memory_resource* upstream_;
+    size_t allocations_ = 0u;
+    size_t bytes_ = 0u;
+};
+
+std::string GenerateInput(int stops_count) {
+    std::ostringstream out;
+    out << "{\"base_requests\": [";
+    for (int i = 0; i < stops_count; ++i) {
+        if (i > 0) {
+            out << ", ";
+        }
+        out << "{\"type\": \"Stop\", \"name\": \"Stop number " << i << " on a long street\", "
+            << "\"latitude\": " << 55.5 + i * 1e-5 << ", \"longitude\": " << 37.5 + i * 1e-5 << ", "
+            << "\"road_distances\": {";
+        for (int j = 1; j <= 5; ++j) {
+            if (j > 1) {
+                out << ", ";
+            }
+            out << "\"Stop number " << (i + j) % stops_count << " on a long street\": " << 100 * j;
+        }
+        out << "}}";
+    }
+    out << "]}";
+    return out.str();
+}
+
+double MillisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void Report(const char* name, const CountingResource& counter, double parse_ms, double release_ms) {
+    std::cout << name << ": allocations " << counter.GetAllocations()
+        << ", bytes " << counter.GetBytes()
+        << ", parse " << parse_ms << " ms"
+        << ", release " << release_ms << " ms" << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::string input;
+    if (argc > 1) {
+        std::ifstream file(argv[1], std::ios::binary);
+        input = json::ReadAll(file);
+    }
+    else {
+        input = GenerateInput(200000);
+    }
+    std::cout << "input: " << input.size() << " bytes" << std::endl;
+
+    {
+        // Каждый узел - отдельное выделение из кучи
+        CountingResource counter(std::pmr::new_delete_resource());
+        std::pmr::memory_resource* previous = std::pmr::set_default_resource(&counter);
+
+        auto start = std::chrono::steady_clock::now();
+        std::optional<json::Document> doc(json::Load(input));
+        const double parse_ms = MillisecondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        doc.reset();
+        const double release_ms = MillisecondsSince(start);
+
+        std::pmr::set_default_resource(previous);
+        Report("heap ", counter, parse_ms, release_ms);
+    }
+
+    {
+        // Узлы размещаются в арене, которая запрашивает у кучи крупные блоки
+        CountingResource counter(std::pmr::new_delete_resource());
+        std::optional<std::pmr::monotonic_buffer_resource> arena(&counter);
+
+        auto start = std::chrono::steady_clock::now();
+        std::optional<json::Document> doc(json::Load(input, *arena));
+        const double parse_ms = MillisecondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        doc.reset();
+        arena.reset();
+        const double release_ms = MillisecondsSince(start);
+
+        Report("arena", counter, parse_ms, release_ms);
+    }
+
+    {
+        // Лента токенов без дерева, значения читаются по требованию
+        std::optional<json::LazyDocument> doc;
+        auto start = std::chrono::steady_clock::now();
+        doc.emplace(input);
+        const double parse_ms = MillisecondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        size_t names_size = 0u;
+        const json::LazyDict root = doc->GetRoot().AsDict();
+        if (root.count("base_requests")) {
+            for (const json::LazyNode request : root.at("base_requests").AsArray()) {
+                names_size += request.AsDict().at("name").AsString().size();
+            }
+        }
+        const double read_ms = MillisecondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        doc.reset();
+        const double release_ms = MillisecondsSince(start);
+
+        std::cout << "lazy : parse " << parse_ms << " ms"
+            << ", read names " << read_ms << " ms (" << names_size << " bytes)"
+            << ", release " << release_ms << " ms" << std::endl;
+    }
+
+    {
+        // Запросы заполняют доменные структуры прямо из событий парсера.
+        // Структуры запросов размещаются не через memory_resource, поэтому
+        // выделения здесь не подсчитываются.
+        std::optional<std::pmr::monotonic_buffer_resource> arena;
+        arena.emplace();
+
+        auto start = std::chrono::steady_clock::now();
+        std::optional<json_reader::RequestsDecoder> decoder(&*arena);
+        json::Parse(input, *decoder);
+        const double parse_ms = MillisecondsSince(start);
+        const size_t stops_count = decoder->GetBaseRequests().stops.size();
+
+        start = std::chrono::steady_clock::now();
+        decoder.reset();
+        arena.reset();
+        const double release_ms = MillisecondsSince(start);
+
+        std::cout << "decoder: parse " << parse_ms << " ms (" << stops_count << " stops)"
+            << ", release " << release_ms << " ms" << std::endl;
+    }
+}
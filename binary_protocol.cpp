@@ -0,0 +1,264 @@
+#include "binary_protocol.h"
+
+#include <cstring>
+
+namespace binary {
+using namespace std::literals;
+
+namespace {
+
+// Запросы больше этого размера считаются ошибкой клиента
+constexpr uint32_t kMaxFrameSize = 1u << 24;
+
+void PutU8(std::string& out, uint8_t value) {
+    out.push_back(static_cast<char>(value));
+}
+
+void PutU32(std::string& out, uint32_t value) {
+    const char bytes[] = {
+        static_cast<char>(value & 0xFFu),
+        static_cast<char>((value >> 8) & 0xFFu),
+        static_cast<char>((value >> 16) & 0xFFu),
+        static_cast<char>((value >> 24) & 0xFFu)
+    };
+    out.append(bytes, sizeof(bytes));
+}
+
+void PutI32(std::string& out, int32_t value) {
+    PutU32(out, static_cast<uint32_t>(value));
+}
+
+void PutF64(std::string& out, double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    PutU32(out, static_cast<uint32_t>(bits & 0xFFFFFFFFu));
+    PutU32(out, static_cast<uint32_t>(bits >> 32));
+}
+
+void PutString(std::string& out, std::string_view value) {
+    PutU32(out, static_cast<uint32_t>(value.size()));
+    out.append(value);
+}
+
+uint32_t LoadU32(const char* data) {
+    const auto* bytes = reinterpret_cast<const unsigned char*>(data);
+    return static_cast<uint32_t>(bytes[0])
+        | static_cast<uint32_t>(bytes[1]) << 8
+        | static_cast<uint32_t>(bytes[2]) << 16
+        | static_cast<uint32_t>(bytes[3]) << 24;
+}
+
+// Последовательное чтение полей нагрузки с проверкой границ
+class PayloadReader {
+public:
+    explicit PayloadReader(std::string_view data)
+        : data_(data) {
+    }
+
+    uint8_t ReadU8() {
+        Require(1u);
+        return static_cast<uint8_t>(data_[pos_++]);
+    }
+
+    uint32_t ReadU32() {
+        Require(4u);
+        const uint32_t value = LoadU32(data_.data() + pos_);
+        pos_ += 4u;
+        return value;
+    }
+
+    int32_t ReadI32() {
+        return static_cast<int32_t>(ReadU32());
+    }
+
+    std::string_view ReadString() {
+        const uint32_t size = ReadU32();
+        Require(size);
+        const std::string_view value = data_.substr(pos_, size);
+        pos_ += size;
+        return value;
+    }
+
+    bool AtEnd() const {
+        return pos_ == data_.size();
+    }
+
+private:
+    void Require(size_t size) const {
+        if (data_.size() - pos_ < size) {
+            throw ProtocolError("Unexpected end of request"s);
+        }
+    }
+
+    std::string_view data_;
+    size_t pos_ = 0u;
+};
+
+reader::QueryType ReadQueryType(PayloadReader& input) {
+    const uint8_t type = input.ReadU8();
+    if (type > static_cast<uint8_t>(reader::QueryType::kRoute)) {
+        throw ProtocolError("Unknown request type"s);
+    }
+    return static_cast<reader::QueryType>(type);
+}
+
+std::string ReadStopRef(PayloadReader& input, const tc::TransportCatalogue& catalog) {
+    switch (static_cast<RefKind>(input.ReadU8())) {
+    case RefKind::kName:
+        return std::string(input.ReadString());
+    case RefKind::kId:
+        if (const domain::StopPtr stop = catalog.GetStopById(input.ReadU32())) {
+            return stop->name;
+        }
+        throw ProtocolError("Unknown stop id"s);
+    }
+    throw ProtocolError("Unknown reference kind"s);
+}
+
+std::string ReadBusRef(PayloadReader& input, const tc::TransportCatalogue& catalog) {
+    switch (static_cast<RefKind>(input.ReadU8())) {
+    case RefKind::kName:
+        return std::string(input.ReadString());
+    case RefKind::kId:
+        if (const domain::BusPtr bus = catalog.GetBusById(input.ReadU32())) {
+            return bus->name;
+        }
+        throw ProtocolError("Unknown bus id"s);
+    }
+    throw ProtocolError("Unknown reference kind"s);
+}
+
+void PutHeader(std::string& out, reader::QueryType type, int id, Status status) {
+    PutU8(out, static_cast<uint8_t>(type));
+    PutI32(out, id);
+    PutU8(out, static_cast<uint8_t>(status));
+}
+
+}  // namespace
+
+bool ReadFrame(std::istream& input, std::string& payload) {
+    char size_bytes[4];
+    if (!input.read(size_bytes, sizeof(size_bytes))) {
+        if (input.gcount() == 0) {
+            return false;
+        }
+        throw ProtocolError("Truncated frame header"s);
+    }
+
+    const uint32_t size = LoadU32(size_bytes);
+    if (size > kMaxFrameSize) {
+        throw ProtocolError("Frame is too large"s);
+    }
+    payload.resize(size);
+    if (!input.read(payload.data(), static_cast<std::streamsize>(size))) {
+        throw ProtocolError("Truncated frame"s);
+    }
+    return true;
+}
+
+void WriteFrame(std::ostream& output, std::string_view payload) {
+    std::string header;
+    PutU32(header, static_cast<uint32_t>(payload.size()));
+    output.write(header.data(), static_cast<std::streamsize>(header.size()));
+    output.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+}
+
+reader::StatCommand DecodeRequest(std::string_view payload, const tc::TransportCatalogue& catalog) {
+    PayloadReader input(payload);
+    reader::StatCommand command;
+    command.query_type = ReadQueryType(input);
+    command.id = input.ReadI32();
+
+    switch (command.query_type) {
+    case reader::QueryType::kStop:
+        command.data = ReadStopRef(input, catalog);
+        break;
+    case reader::QueryType::kBus:
+        command.data = ReadBusRef(input, catalog);
+        break;
+    case reader::QueryType::kRoute: {
+        std::string from = ReadStopRef(input, catalog);
+        command.data = reader::RouteCommand{ std::move(from), ReadStopRef(input, catalog) };
+    } break;
+    case reader::QueryType::kMap:
+    case reader::QueryType::kMetrics:
+        break;
+    }
+
+    if (!input.AtEnd()) {
+        throw ProtocolError("Unexpected data after request"s);
+    }
+    return command;
+}
+
+void EncodeResponse(const reader::StatInfo& stat, const tc::TransportCatalogue& catalog, std::string& payload) {
+    payload.clear();
+
+    switch (stat.query_type) {
+    case reader::QueryType::kStop: {
+        const auto& info = std::get<domain::StopStat>(stat.info);
+        if (!info.is_found) {
+            break;
+        }
+        PutHeader(payload, stat.query_type, stat.id, Status::kOk);
+        PutU32(payload, static_cast<uint32_t>(info.data.size()));
+        for (std::string_view bus : info.data) {
+            PutU32(payload, catalog.GetBusByName(bus)->id);
+            PutString(payload, bus);
+        }
+    } break;
+    case reader::QueryType::kBus:
+        if (const domain::BusStat* info = std::get_if<domain::BusStat>(&stat.info)) {
+            PutHeader(payload, stat.query_type, stat.id, Status::kOk);
+            PutF64(payload, info->route_length);
+            PutF64(payload, info->curvature);
+            PutU32(payload, static_cast<uint32_t>(info->stops_count));
+            PutU32(payload, static_cast<uint32_t>(info->unique_stops));
+        }
+        break;
+    case reader::QueryType::kRoute:
+        if (const domain::TRouteStat* info = std::get_if<domain::TRouteStat>(&stat.info)) {
+            PutHeader(payload, stat.query_type, stat.id, Status::kOk);
+            PutF64(payload, info->total_time);
+            PutU32(payload, static_cast<uint32_t>(info->items.size()));
+            for (const domain::TRouteItemStat& item : info->items) {
+                const bool is_wait = item.type == domain::TRouteType::kWait;
+                PutU8(payload, is_wait ? 0u : 1u);
+                PutF64(payload, item.time);
+                PutU32(payload, is_wait ? catalog.GetStopByName(item.name)->id : catalog.GetBusByName(item.name)->id);
+                PutString(payload, item.name);
+                if (!is_wait) {
+                    PutU32(payload, static_cast<uint32_t>(item.span_cout));
+                }
+            }
+        }
+        break;
+    case reader::QueryType::kMap:
+        PutHeader(payload, stat.query_type, stat.id, Status::kOk);
+        PutString(payload, *std::get<std::shared_ptr<const std::string>>(stat.info));
+        break;
+    case reader::QueryType::kMetrics:
+        // Метрики двоичным протоколом не передаются, ReadQueryType их не пропускает
+        break;
+    }
+
+    if (payload.empty()) {
+        PutHeader(payload, stat.query_type, stat.id, Status::kNotFound);
+    }
+}
+
+void EncodeError(std::string_view request, std::string_view message, std::string& payload) {
+    payload.clear();
+    // Заголовок запроса (type:u8 id:i32) повторяется в ответе, если он целый
+    if (request.size() >= 5u) {
+        payload.append(request.substr(0, 5u));
+    }
+    else {
+        PutU8(payload, static_cast<uint8_t>(reader::QueryType::kStop));
+        PutI32(payload, 0);
+    }
+    PutU8(payload, static_cast<uint8_t>(Status::kBadRequest));
+    PutString(payload, message);
+}
+
+}
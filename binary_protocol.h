@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "domain.h"
+#include "transport_catalogue.h"
+
+// Двоичный протокол stat-запросов, альтернатива JSON для клиентов,
+// которым важна задержка. Остановки и автобусы передаются номерами
+// (TransportCatalogue::GetStopById/GetBusById) вместе с именами.
+//
+// Кадр: длина нагрузки (u32) и сама нагрузка. Числа - little-endian,
+// double - IEEE 754 (f64), string - длина (u32) и байты UTF-8.
+//
+// Запрос: type:u8 (reader::QueryType) id:i32, далее
+//   Stop, Bus: ref
+//   Route:     ref(from) ref(to)
+//   Map:       -
+//   ref - kind:u8 (RefKind), затем string для kName или u32 для kId
+//
+// Ответ: type:u8 id:i32 status:u8 (Status), при kOk далее
+//   Stop:  count:u32, затем count раз bus_id:u32 bus_name:string
+//   Bus:   route_length:f64 curvature:f64 stop_count:u32 unique_stop_count:u32
+//   Route: total_time:f64 count:u32, затем count элементов
+//          kind:u8 (0 - Wait, 1 - Bus) time:f64 id:u32 name:string
+//          и span_count:u32 только для Bus; id - номер остановки или автобуса
+//   Map:   svg:string
+// При kBadRequest далее message:string.
+namespace binary {
+
+class ProtocolError : public std::runtime_error {
+public:
+    using runtime_error::runtime_error;
+};
+
+enum class Status : uint8_t {
+    kOk,
+    kNotFound,
+    kBadRequest
+};
+
+enum class RefKind : uint8_t {
+    kName,
+    kId
+};
+
+// Читает следующий кадр. false - поток закончился до начала кадра.
+bool ReadFrame(std::istream& input, std::string& payload);
+void WriteFrame(std::ostream& output, std::string_view payload);
+
+// Номера остановок и автобусов заменяются именами из каталога
+reader::StatCommand DecodeRequest(std::string_view payload, const tc::TransportCatalogue& catalog);
+void EncodeResponse(const reader::StatInfo& stat, const tc::TransportCatalogue& catalog, std::string& payload);
+// Ответ kBadRequest. Тип и номер берутся из заголовка запроса, если он есть.
+void EncodeError(std::string_view request, std::string_view message, std::string& payload);
+
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 #include <variant>
@@ -12,6 +14,8 @@ namespace domain {
 struct Stop {
     std::string name;
     geo::Coordinates position;
+    geo::CoordinatesTrig position_trig; // Заполняется каталогом при добавлении
+    uint32_t id = 0u;                   // Порядковый номер, назначается каталогом
 };
 
 using StopPtr = const Stop*;
@@ -20,6 +24,7 @@ struct Bus {
     std::string name;
     std::vector<StopPtr> stops;
     bool is_roundtrip = false;
+    uint32_t id = 0u;                   // Порядковый номер, назначается каталогом
 };
 
 using BusPtr = const Bus*;
@@ -58,6 +63,22 @@ struct TRouteStat {
     std::vector<TRouteItemStat> items;
 };
 
+struct HistogramStat {
+    std::string name;
+    uint64_t count = 0u;
+    uint64_t total = 0u;    // Сумма значений, нс
+    uint64_t max = 0u;
+    uint64_t p50 = 0u;
+    uint64_t p90 = 0u;
+    uint64_t p99 = 0u;
+};
+
+struct MetricsStat {
+    bool enabled = false;
+    std::vector<std::pair<std::string, uint64_t>> counters;
+    std::vector<HistogramStat> histograms;
+};
+
 }
 
 namespace reader {
@@ -66,7 +87,8 @@ enum class QueryType {
     kStop,
     kBus,
     kMap,
-    kRoute
+    kRoute,
+    kMetrics
 };
 
 struct RouteCommand {
@@ -83,7 +105,9 @@ struct StatCommand {
 struct StatInfo {
     int id = 0;
     QueryType query_type = QueryType::kStop;
-    std::variant <std::monostate, domain::StopStat, domain::BusStat, domain::TRouteStat, std::string> info;
+    // Карта - общий для всех запросов отрисованный SVG, ответ его не копирует
+    std::variant <std::monostate, domain::StopStat, domain::BusStat, domain::TRouteStat,
+        std::shared_ptr<const std::string>, domain::MetricsStat> info;
 };
 
 }
@@ -1,17 +1,269 @@
 #define _USE_MATH_DEFINES
 #include "geo.h"
 
+#include <algorithm>
 #include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 namespace geo {
 
+namespace {
+
+const int kRadiusEarth = 6371000;
+const double kDegToRad = M_PI / 180.0;
+
+// Операции над одним значением для скалярной ветки ядра
+inline double Sqrt(double value) {
+    return std::sqrt(value);
+}
+
+inline double Min(double lhs, double rhs) {
+    return lhs < rhs ? lhs : rhs;
+}
+
+inline double Abs(double value) {
+    return std::abs(value);
+}
+
+#ifdef __SSE2__
+// Пара значений в одном SSE-регистре
+struct Double2 {
+    __m128d value;
+
+    Double2(__m128d val)
+        : value(val) {
+    }
+    Double2(double val)
+        : value(_mm_set1_pd(val)) {
+    }
+};
+
+inline Double2 operator+(Double2 lhs, Double2 rhs) {
+    return _mm_add_pd(lhs.value, rhs.value);
+}
+
+inline Double2 operator-(Double2 lhs, Double2 rhs) {
+    return _mm_sub_pd(lhs.value, rhs.value);
+}
+
+inline Double2 operator*(Double2 lhs, Double2 rhs) {
+    return _mm_mul_pd(lhs.value, rhs.value);
+}
+
+inline Double2 operator/(Double2 lhs, Double2 rhs) {
+    return _mm_div_pd(lhs.value, rhs.value);
+}
+
+inline Double2 Sqrt(Double2 val) {
+    return _mm_sqrt_pd(val.value);
+}
+
+inline Double2 Min(Double2 lhs, Double2 rhs) {
+    return _mm_min_pd(lhs.value, rhs.value);
+}
+
+inline Double2 Abs(Double2 val) {
+    return _mm_andnot_pd(_mm_set1_pd(-0.0), val.value);
+}
+#endif
+
+// sin(x) для |x| <= pi/2, ряд Тейлора до x^21 (погрешность меньше 1e-17)
+template <typename Real>
+Real SinPoly(Real x) {
+    const Real x2 = x * x;
+    Real p = Real(1.0 / 51090942171709440000.0);
+    p = p * x2 + Real(-1.0 / 121645100408832000.0);
+    p = p * x2 + Real(1.0 / 355687428096000.0);
+    p = p * x2 + Real(-1.0 / 1307674368000.0);
+    p = p * x2 + Real(1.0 / 6227020800.0);
+    p = p * x2 + Real(-1.0 / 39916800.0);
+    p = p * x2 + Real(1.0 / 362880.0);
+    p = p * x2 + Real(-1.0 / 5040.0);
+    p = p * x2 + Real(1.0 / 120.0);
+    p = p * x2 + Real(-1.0 / 6.0);
+    return x + x * x2 * p;
+}
+
+// asin(x) для 0 <= x <= sin(pi/16), ряд Тейлора до x^19 (погрешность меньше 1e-16)
+template <typename Real>
+Real AsinPoly(Real x) {
+    const Real x2 = x * x;
+    Real p = Real(12155.0 / 1245184.0);
+    p = p * x2 + Real(6435.0 / 557056.0);
+    p = p * x2 + Real(143.0 / 10240.0);
+    p = p * x2 + Real(231.0 / 13312.0);
+    p = p * x2 + Real(63.0 / 2816.0);
+    p = p * x2 + Real(35.0 / 1152.0);
+    p = p * x2 + Real(5.0 / 112.0);
+    p = p * x2 + Real(3.0 / 40.0);
+    p = p * x2 + Real(1.0 / 6.0);
+    return x + x * x2 * p;
+}
+
+// Расстояние по формуле гаверсинусов без ветвлений.
+// Центральный угол 2*asin(s) трижды делится пополам через sqrt,
+// после чего аргумент asin не превышает sin(pi/16) и ряд быстро сходится.
+template <typename Real>
+Real Haversine(Real lat1, Real lng1, Real cos_lat1, Real lat2, Real lng2, Real cos_lat2) {
+    const Real half_dr = Real(kDegToRad / 2.0);
+    const Real sin_dlat = SinPoly((lat2 - lat1) * half_dr);
+
+    // sin^2 симметричен относительно pi/2, поэтому аргумент приводится к [0, pi/2]
+    Real dlng = Abs(lng2 - lng1) * half_dr;
+    dlng = Min(dlng, Real(M_PI) - dlng);
+    const Real sin_dlng = SinPoly(dlng);
+
+    const Real h = Min(sin_dlat * sin_dlat + cos_lat1 * cos_lat2 * sin_dlng * sin_dlng, Real(1.0));
+
+    Real s = Sqrt(h);
+    Real c = Sqrt(Real(1.0) - h);
+    for (int i = 0; i < 3; ++i) {
+        const Real d = Sqrt(Real(2.0) * (Real(1.0) + c));
+        s = s / d;
+        c = d * Real(0.5);
+    }
+
+    return AsinPoly(s) * Real(16.0 * kRadiusEarth);
+}
+
+}  // namespace
+
 double ComputeDistance(Coordinates from, Coordinates to) {
     using namespace std;
-    const  int radius_earth = 6371000; 
+    const  int radius_earth = 6371000;
     const double dr = M_PI / 180.0;
     return acos(sin(from.lat * dr) * sin(to.lat * dr)
                 + cos(from.lat * dr) * cos(to.lat * dr) * cos(abs(from.lng - to.lng) * dr))
         * radius_earth;
 }
 
-}  // namespace geo
\ No newline at end of file
+CoordinatesTrig::CoordinatesTrig(Coordinates coords)
+    : lat(coords.lat * kDegToRad)
+    , lng(coords.lng * kDegToRad)
+    , sin_lat(std::sin(lat))
+    , cos_lat(std::cos(lat)) {
+}
+
+double ComputeDistance(const CoordinatesTrig& from, const CoordinatesTrig& to) {
+    using namespace std;
+    return acos(min(1.0, from.sin_lat * to.sin_lat + from.cos_lat * to.cos_lat * cos(abs(from.lng - to.lng))))
+        * kRadiusEarth;
+}
+
+double ComputeDistanceApprox(const CoordinatesTrig& from, const CoordinatesTrig& to) {
+    using namespace std;
+    // cos средней широты: cos((a + b) / 2) = sqrt((1 + cos(a) * cos(b) - sin(a) * sin(b)) / 2)
+    const double cos_mean_lat
+        = sqrt(max(0.0, (1.0 + from.cos_lat * to.cos_lat - from.sin_lat * to.sin_lat) * 0.5));
+
+    double dlng = abs(from.lng - to.lng);
+    if (dlng > M_PI) {
+        dlng = 2.0 * M_PI - dlng;
+    }
+    const double x = dlng * cos_mean_lat;
+    const double y = to.lat - from.lat;
+
+    return sqrt(x * x + y * y) * kRadiusEarth;
+}
+
+double ComputeDistance(const CoordinatesTrig& from, const CoordinatesTrig& to, DistanceMode mode) {
+    switch (mode) {
+    case DistanceMode::kEquirectangular:
+        return ComputeDistanceApprox(from, to);
+    case DistanceMode::kExact:
+        break;
+    }
+
+    return ComputeDistance(from, to);
+}
+
+void CoordinatesArray::Reserve(size_t size) {
+    lat_.reserve(size);
+    lng_.reserve(size);
+    cos_lat_.reserve(size);
+}
+
+void CoordinatesArray::PushBack(Coordinates coords) {
+    PushBack(coords, std::cos(coords.lat * kDegToRad));
+}
+
+void CoordinatesArray::PushBack(Coordinates coords, double cos_lat) {
+    lat_.push_back(coords.lat);
+    lng_.push_back(coords.lng);
+    cos_lat_.push_back(cos_lat);
+}
+
+size_t CoordinatesArray::Size() const {
+    return lat_.size();
+}
+
+const double* CoordinatesArray::Lat() const {
+    return lat_.data();
+}
+
+const double* CoordinatesArray::Lng() const {
+    return lng_.data();
+}
+
+const double* CoordinatesArray::CosLat() const {
+    return cos_lat_.data();
+}
+
+void ComputeDistances(const double* from_lat, const double* from_lng, const double* from_cos_lat,
+    const double* to_lat, const double* to_lng, const double* to_cos_lat,
+    double* result, size_t count) {
+    size_t i = 0u;
+#ifdef __SSE2__
+    for (; i + 2u <= count; i += 2u) {
+        const Double2 distance = Haversine(
+            Double2(_mm_loadu_pd(from_lat + i)), Double2(_mm_loadu_pd(from_lng + i)),
+            Double2(_mm_loadu_pd(from_cos_lat + i)),
+            Double2(_mm_loadu_pd(to_lat + i)), Double2(_mm_loadu_pd(to_lng + i)),
+            Double2(_mm_loadu_pd(to_cos_lat + i)));
+        _mm_storeu_pd(result + i, distance.value);
+    }
+#endif
+    for (; i < count; ++i) {
+        result[i] = Haversine(from_lat[i], from_lng[i], from_cos_lat[i], to_lat[i], to_lng[i], to_cos_lat[i]);
+    }
+}
+
+void ComputeDistances(const CoordinatesArray& from, const CoordinatesArray& to, std::vector<double>& result) {
+    using namespace std::literals;
+    if (from.Size() != to.Size()) {
+        throw std::invalid_argument("Coordinates arrays have different sizes"s);
+    }
+
+    result.resize(from.Size());
+    ComputeDistances(from.Lat(), from.Lng(), from.CosLat(), to.Lat(), to.Lng(), to.CosLat(),
+        result.data(), from.Size());
+}
+
+double ComputePathLength(const CoordinatesArray& points) {
+    if (points.Size() < 2u) {
+        return 0.0;
+    }
+
+    // Отрезки пути: точки [0, n-1) и [1, n) одного и того же массива.
+    // Расстояния считаются блоками в буфер на стеке, без выделения памяти.
+    constexpr size_t kBlockSize = 64u;
+    double distances[kBlockSize];
+    const size_t count = points.Size() - 1u;
+    double result = 0.0;
+    for (size_t begin = 0u; begin < count; begin += kBlockSize) {
+        const size_t size = std::min(kBlockSize, count - begin);
+        ComputeDistances(points.Lat() + begin, points.Lng() + begin, points.CosLat() + begin,
+            points.Lat() + begin + 1, points.Lng() + begin + 1, points.CosLat() + begin + 1,
+            distances, size);
+        result = std::accumulate(distances, distances + size, result);
+    }
+
+    return result;
+}
+
+}  // namespace geo
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstddef>
+#include <vector>
+
 namespace geo {
 
 struct Coordinates {
@@ -9,4 +12,66 @@ struct Coordinates {
 
 double ComputeDistance(Coordinates from, Coordinates to);
 
-}  // namespace geo
\ No newline at end of file
+// Способ вычисления расстояния по прямой
+enum class DistanceMode {
+    kExact,           // Сферическая формула, как в ComputeDistance
+    kEquirectangular  // Равнопромежуточная проекция, только для коротких перегонов
+};
+
+// Координаты в радианах с заранее вычисленными sin и cos широты.
+// Точки остановок неподвижны, поэтому значения считаются один раз.
+struct CoordinatesTrig {
+    CoordinatesTrig() = default;
+    explicit CoordinatesTrig(Coordinates coords);
+
+    double lat = 0.0;
+    double lng = 0.0;
+    double sin_lat = 0.0;
+    double cos_lat = 1.0;
+};
+
+// То же, что ComputeDistance, но с одним вызовом cos вместо пяти вызовов sin и cos
+double ComputeDistance(const CoordinatesTrig& from, const CoordinatesTrig& to);
+
+// Приближение равнопромежуточной проекцией без тригонометрических вызовов.
+// При широте до 80 градусов относительная погрешность не превышает 1e-7 для перегонов
+// до 1 км, 5e-6 до 10 км и 5e-4 до 100 км.
+double ComputeDistanceApprox(const CoordinatesTrig& from, const CoordinatesTrig& to);
+
+double ComputeDistance(const CoordinatesTrig& from, const CoordinatesTrig& to, DistanceMode mode);
+
+// Набор координат в виде структуры массивов для пакетных вычислений.
+// Косинус широты считается один раз при добавлении точки.
+class CoordinatesArray {
+public:
+    void Reserve(size_t size);
+    void PushBack(Coordinates coords);
+    void PushBack(Coordinates coords, double cos_lat);
+    size_t Size() const;
+
+    const double* Lat() const;
+    const double* Lng() const;
+    const double* CosLat() const;
+
+private:
+    std::vector<double> lat_;
+    std::vector<double> lng_;
+    std::vector<double> cos_lat_;
+};
+
+// Пакетный аналог ComputeDistance: result[i] = расстояние от from[i] до to[i].
+// Используется формула гаверсинусов с полиномиальными sin и asin без ветвлений,
+// которые обрабатываются по несколько пар за раз (SSE2, если доступно).
+// Относительная погрешность относительно точной формулы не превышает 2e-13. Отличие от ComputeDistance
+// определяется потерей точности acos в ней самой и составляет порядка R^2 * 2^-53 / d,
+// то есть около 4.5e-3 м^2 / d (0.005 мм для перегона в 1 км).
+void ComputeDistances(const double* from_lat, const double* from_lng, const double* from_cos_lat,
+    const double* to_lat, const double* to_lng, const double* to_cos_lat,
+    double* result, size_t count);
+
+void ComputeDistances(const CoordinatesArray& from, const CoordinatesArray& to, std::vector<double>& result);
+
+// Длина ломаной, проходящей через все точки по порядку
+double ComputePathLength(const CoordinatesArray& points);
+
+}  // namespace geo
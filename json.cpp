@@ -1,9 +1,370 @@
 #include "json.h"
 
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <functional>
 #include <iterator>
+#include <memory>
+#include <new>
+#include <utility>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace json {
 
+//----------------- SmallString -----------------------
+
+SmallString::SmallString() noexcept {
+    data_[kInlineCapacity] = static_cast<char>(kInlineCapacity);
+}
+
+SmallString::SmallString(std::string_view value) {
+    Assign(value, std::pmr::get_default_resource());
+}
+
+SmallString::SmallString(std::string_view value, std::pmr::memory_resource* resource) {
+    Assign(value, resource);
+}
+
+SmallString::SmallString(const std::string& value)
+    : SmallString(std::string_view(value)) {
+}
+
+SmallString::SmallString(const char* value)
+    : SmallString(std::string_view(value)) {
+}
+
+SmallString::SmallString(const SmallString& other) {
+    Assign(other.View(), std::pmr::get_default_resource());
+}
+
+SmallString::SmallString(SmallString&& other) noexcept {
+    std::memcpy(data_, other.data_, sizeof(data_));
+    other.data_[kInlineCapacity] = static_cast<char>(kInlineCapacity);
+}
+
+SmallString& SmallString::operator=(const SmallString& other) {
+    if (this != &other) {
+        SmallString copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+SmallString& SmallString::operator=(SmallString&& other) noexcept {
+    if (this != &other) {
+        Release();
+        std::memcpy(data_, other.data_, sizeof(data_));
+        other.data_[kInlineCapacity] = static_cast<char>(kInlineCapacity);
+    }
+    return *this;
+}
+
+SmallString::~SmallString() {
+    Release();
+}
+
+void SmallString::Assign(std::string_view value, std::pmr::memory_resource* resource) {
+    using namespace std::literals;
+    if (value.size() <= kInlineCapacity) {
+        std::memcpy(data_, value.data(), value.size());
+        data_[kInlineCapacity] = static_cast<char>(kInlineCapacity - value.size());
+        return;
+    }
+    if (value.size() > UINT32_MAX) {
+        throw std::length_error("String is too long"s);
+    }
+
+    void* block = resource->allocate(sizeof(resource) + value.size(), alignof(std::pmr::memory_resource*));
+    std::memcpy(block, &resource, sizeof(resource));
+    char* ptr = static_cast<char*>(block) + sizeof(resource);
+    std::memcpy(ptr, value.data(), value.size());
+    const uint32_t size = static_cast<uint32_t>(value.size());
+    std::memcpy(data_, &ptr, sizeof(ptr));
+    std::memcpy(data_ + sizeof(ptr), &size, sizeof(size));
+    data_[kInlineCapacity] = kLongTag;
+}
+
+void SmallString::Release() noexcept {
+    if (IsLong()) {
+        char* ptr;
+        uint32_t size;
+        std::memcpy(&ptr, data_, sizeof(ptr));
+        std::memcpy(&size, data_ + sizeof(ptr), sizeof(size));
+
+        std::pmr::memory_resource* resource;
+        char* block = ptr - sizeof(resource);
+        std::memcpy(&resource, block, sizeof(resource));
+        resource->deallocate(block, sizeof(resource) + size, alignof(std::pmr::memory_resource*));
+        data_[kInlineCapacity] = static_cast<char>(kInlineCapacity);
+    }
+}
+
+//----------------- Dict -----------------------
+
+Dict::Dict(std::pmr::memory_resource* resource)
+    : resource_(resource) {
+}
+
+Dict::Dict(const Dict& other) {
+    *this = other;
+}
+
+Dict::Dict(Dict&& other) noexcept
+    : items_(std::exchange(other.items_, nullptr))
+    , size_(std::exchange(other.size_, 0u))
+    , capacity_(std::exchange(other.capacity_, 0u))
+    , resource_(other.resource_)
+    , index_(std::exchange(other.index_, nullptr)) {
+}
+
+Dict& Dict::operator=(const Dict& other) {
+    if (this == &other) {
+        return *this;
+    }
+    Release();
+    reserve(other.size_);
+    for (const auto& [key, value] : other) {
+        // Ключи other различны, искать их не нужно
+        new (items_ + size_) value_type(key, value);
+        ++size_;
+    }
+    BuildIndex();
+    return *this;
+}
+
+// Как у std::pmr-контейнеров: память забирается только из того же ресурса
+Dict& Dict::operator=(Dict&& other) {
+    if (this == &other) {
+        return *this;
+    }
+    if (*resource_ != *other.resource_) {
+        return *this = static_cast<const Dict&>(other);
+    }
+    Release();
+    items_ = std::exchange(other.items_, nullptr);
+    size_ = std::exchange(other.size_, 0u);
+    capacity_ = std::exchange(other.capacity_, 0u);
+    index_ = std::exchange(other.index_, nullptr);
+    return *this;
+}
+
+Dict::~Dict() {
+    Release();
+}
+
+Dict::iterator Dict::begin() noexcept {
+    return items_;
+}
+
+Dict::iterator Dict::end() noexcept {
+    return items_ + size_;
+}
+
+Dict::const_iterator Dict::begin() const noexcept {
+    return items_;
+}
+
+Dict::const_iterator Dict::end() const noexcept {
+    return items_ + size_;
+}
+
+size_t Dict::size() const noexcept {
+    return size_;
+}
+
+bool Dict::empty() const noexcept {
+    return size_ == 0u;
+}
+
+void Dict::reserve(size_t size) {
+    if (size > capacity_) {
+        Grow(static_cast<uint32_t>(size));
+    }
+}
+
+Dict::iterator Dict::find(std::string_view key) {
+    uint32_t* slot;
+    return items_ + Lookup(key, slot);
+}
+
+Dict::const_iterator Dict::find(std::string_view key) const {
+    uint32_t* slot;
+    return items_ + Lookup(key, slot);
+}
+
+size_t Dict::count(std::string_view key) const {
+    return find(key) != end() ? 1u : 0u;
+}
+
+Node& Dict::at(std::string_view key) {
+    using namespace std::literals;
+    auto it = find(key);
+    if (it == end()) {
+        throw std::out_of_range("Key '"s + std::string(key) + "' is not found"s);
+    }
+    return it->second;
+}
+
+const Node& Dict::at(std::string_view key) const {
+    using namespace std::literals;
+    auto it = find(key);
+    if (it == end()) {
+        throw std::out_of_range("Key '"s + std::string(key) + "' is not found"s);
+    }
+    return it->second;
+}
+
+Node& Dict::operator[](std::string_view key) {
+    uint32_t* slot;
+    const uint32_t pos = Lookup(key, slot);
+    if (pos != size_) {
+        return items_[pos].second;
+    }
+    return Append(SmallString(key), Node{}, slot)->second;
+}
+
+std::pair<Dict::iterator, bool> Dict::emplace(SmallString key, Node value) {
+    uint32_t* slot;
+    const uint32_t pos = Lookup(key, slot);
+    if (pos != size_) {
+        return { items_ + pos, false };
+    }
+    return { Append(std::move(key), std::move(value), slot), true };
+}
+
+// Порядок ключей на равенство не влияет, как и у std::map
+bool Dict::operator==(const Dict& rhs) const {
+    if (size() != rhs.size()) {
+        return false;
+    }
+    for (const auto& [key, value] : *this) {
+        auto it = rhs.find(key);
+        if (it == rhs.end() || !(it->second == value)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Dict::operator!=(const Dict& rhs) const {
+    return !(*this == rhs);
+}
+
+uint32_t Dict::GetIndexSize(uint32_t capacity) noexcept {
+    if (capacity <= kIndexThreshold) {
+        return 0u;
+    }
+    // Заполнение индекса не больше половины
+    uint32_t size = 2u * kIndexThreshold;
+    while (size < 2u * capacity) {
+        size *= 2u;
+    }
+    return size;
+}
+
+uint32_t Dict::Lookup(std::string_view key, uint32_t*& slot) const noexcept {
+    slot = nullptr;
+    if (!index_) {
+        for (uint32_t i = 0u; i < size_; ++i) {
+            if (items_[i].first.View() == key) {
+                return i;
+            }
+        }
+        return size_;
+    }
+
+    const size_t mask = GetIndexSize(capacity_) - 1u;
+    for (size_t i = std::hash<std::string_view>{}(key) & mask; ; i = (i + 1u) & mask) {
+        if (index_[i] == 0u || items_[index_[i] - 1u].first.View() == key) {
+            slot = index_ + i;
+            return index_[i] == 0u ? size_ : index_[i] - 1u;
+        }
+    }
+}
+
+Dict::iterator Dict::Append(SmallString&& key, Node&& value, uint32_t* slot) {
+    if (size_ == capacity_) {
+        Grow(std::max(4u, capacity_ * 2u));
+        // Индекс перестроен, ячейка для ключа могла измениться
+        Lookup(key.View(), slot);
+    }
+    value_type* item = new (items_ + size_) value_type(std::move(key), std::move(value));
+    ++size_;
+    if (slot) {
+        *slot = size_;
+    }
+    return item;
+}
+
+void Dict::Grow(uint32_t capacity) {
+    auto* items = static_cast<value_type*>(resource_->allocate(capacity * sizeof(value_type), alignof(value_type)));
+    for (uint32_t i = 0u; i < size_; ++i) {
+        new (items + i) value_type(std::move(items_[i]));
+        items_[i].~value_type();
+    }
+    if (items_) {
+        resource_->deallocate(items_, capacity_ * sizeof(value_type), alignof(value_type));
+    }
+    if (index_) {
+        resource_->deallocate(index_, GetIndexSize(capacity_) * sizeof(uint32_t), alignof(uint32_t));
+        index_ = nullptr;
+    }
+    items_ = items;
+    capacity_ = capacity;
+    if (const uint32_t index_size = GetIndexSize(capacity_)) {
+        index_ = static_cast<uint32_t*>(resource_->allocate(index_size * sizeof(uint32_t), alignof(uint32_t)));
+        BuildIndex();
+    }
+}
+
+void Dict::BuildIndex() noexcept {
+    if (!index_) {
+        return;
+    }
+    const size_t mask = GetIndexSize(capacity_) - 1u;
+    std::fill(index_, index_ + mask + 1u, 0u);
+    for (uint32_t pos = 0u; pos < size_; ++pos) {
+        size_t i = std::hash<std::string_view>{}(items_[pos].first.View()) & mask;
+        while (index_[i] != 0u) {
+            i = (i + 1u) & mask;
+        }
+        index_[i] = pos + 1u;
+    }
+}
+
+void Dict::Release() noexcept {
+    for (uint32_t i = 0u; i < size_; ++i) {
+        items_[i].~value_type();
+    }
+    if (items_) {
+        resource_->deallocate(items_, capacity_ * sizeof(value_type), alignof(value_type));
+    }
+    if (index_) {
+        resource_->deallocate(index_, GetIndexSize(capacity_) * sizeof(uint32_t), alignof(uint32_t));
+    }
+    items_ = nullptr;
+    index_ = nullptr;
+    size_ = 0u;
+    capacity_ = 0u;
+}
+
 //----------------- Node -----------------------
 
 bool Node::IsInt() const {
@@ -65,16 +426,16 @@ const Array& Node::AsArray() const {
 }
 
 bool Node::IsString() const {
-    return std::holds_alternative<std::string>(*this);
+    return std::holds_alternative<SmallString>(*this);
 }
 
-const std::string& Node::AsString() const {
+std::string_view Node::AsString() const {
     using namespace std::literals;
     if (!IsString()) {
         throw std::logic_error("Not a string"s);
     }
 
-    return std::get<std::string>(*this);
+    return std::get<SmallString>(*this).View();
 }
 
 bool Node::IsDict() const {
@@ -98,6 +459,10 @@ const Node::Value& Node::GetValue() const {
     return *this;
 }
 
+Node::Value& Node::GetValue() {
+    return *this;
+}
+
 inline bool operator!=(const Node& lhs, const Node& rhs) {
     return !(lhs == rhs);
 }
@@ -107,346 +472,843 @@ inline bool operator!=(const Node& lhs, const Node& rhs) {
 namespace {
 using namespace std::literals;
 
-Node LoadNode(std::istream& input);
-Node LoadString(std::istream& input);
+inline bool IsSpace(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v' || c == '\f';
+}
 
-std::string LoadLiteral(std::istream& input) {
-    std::string s;
-    while (std::isalpha(input.peek())) {
-        s.push_back(static_cast<char>(input.get()));
-    }
-    return s;
+inline bool IsDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+inline bool IsAlpha(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
 }
 
-Node LoadArray(std::istream& input) {
-    std::vector<Node> result;
+inline bool IsNumberChar(char c) {
+    return IsDigit(c) || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+}
+
+//----------------- Vectorised scanning -----------------------
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define JSON_SIMD_SSE2
+#endif
+
+// Номер младшего установленного бита, mask != 0
+inline unsigned CountTrailingZeros(unsigned mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
 
-    for (char c; input >> c && c != ']';) {
-        if (c != ',') {
-            input.putback(c);
+// Ищет первую кавычку, обратную косую черту или управляющий символ (< 0x20).
+// Проверяется по 32 байта (AVX2) или по 16 байт (SSE2), остаток - по одному.
+inline const char* FindStringSpecial(const char* pos, const char* end) {
+#ifdef __AVX2__
+    const __m256i quote32 = _mm256_set1_epi8('"');
+    const __m256i backslash32 = _mm256_set1_epi8('\\');
+    const __m256i control32 = _mm256_set1_epi8(0x1F);
+    for (; end - pos >= 32; pos += 32) {
+        const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pos));
+        const __m256i special = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote32), _mm256_cmpeq_epi8(chunk, backslash32)),
+            _mm256_cmpeq_epi8(_mm256_min_epu8(chunk, control32), chunk));
+        if (const unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(special))) {
+            return pos + CountTrailingZeros(mask);
         }
-        result.push_back(LoadNode(input));
     }
-    if (!input) {
-        throw ParsingError("Array parsing error"s);
+#endif
+#ifdef JSON_SIMD_SSE2
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control = _mm_set1_epi8(0x1F);
+    for (; end - pos >= 16; pos += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+        const __m128i special = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+            _mm_cmpeq_epi8(_mm_min_epu8(chunk, control), chunk));
+        if (const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(special))) {
+            return pos + CountTrailingZeros(mask);
+        }
+    }
+#endif
+    for (; pos != end; ++pos) {
+        const unsigned char c = static_cast<unsigned char>(*pos);
+        if (c == '"' || c == '\\' || c < 0x20) {
+            break;
+        }
     }
-    return Node(std::move(result));
+    return pos;
 }
 
-Node LoadDict(std::istream& input) {
-    Dict dict;
-
-    for (char c; input >> c && c != '}';) {
-        if (c == '"') {
-            std::string key = LoadString(input).AsString();
-            if (input >> c && c == ':') {
-                if (dict.find(key) != dict.end()) {
-                    throw ParsingError("Duplicate key '"s + key + "' have been found"s);
-                }
-                dict.emplace(std::move(key), LoadNode(input));
-            }
-            else {
-                throw ParsingError(": is expected but '"s + c + "' has been found"s);
-            }
+// Пропускает пробельные символы: ' ' и диапазон '\t'..'\r'
+inline const char* SkipSpaces(const char* pos, const char* end) {
+#ifdef __AVX2__
+    const __m256i space32 = _mm256_set1_epi8(' ');
+    const __m256i below_tab32 = _mm256_set1_epi8('\t' - 1);
+    const __m256i above_cr32 = _mm256_set1_epi8('\r' + 1);
+    for (; end - pos >= 32; pos += 32) {
+        const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pos));
+        const __m256i spaces = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, space32),
+            _mm256_and_si256(_mm256_cmpgt_epi8(chunk, below_tab32), _mm256_cmpgt_epi8(above_cr32, chunk)));
+        if (const unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(spaces))) {
+            return pos + CountTrailingZeros(mask);
         }
-        else if (c != ',') {
-            throw ParsingError(R"(',' is expected but ')"s + c + "' has been found"s);
+    }
+#endif
+#ifdef JSON_SIMD_SSE2
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i below_tab = _mm_set1_epi8('\t' - 1);
+    const __m128i above_cr = _mm_set1_epi8('\r' + 1);
+    for (; end - pos >= 16; pos += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+        const __m128i spaces = _mm_or_si128(_mm_cmpeq_epi8(chunk, space),
+            _mm_and_si128(_mm_cmpgt_epi8(chunk, below_tab), _mm_cmplt_epi8(chunk, above_cr)));
+        if (const unsigned mask = ~static_cast<unsigned>(_mm_movemask_epi8(spaces)) & 0xFFFFu) {
+            return pos + CountTrailingZeros(mask);
         }
     }
-    if (!input) {
-        throw ParsingError("Dictionary parsing error"s);
+#endif
+    while (pos != end && IsSpace(*pos)) {
+        ++pos;
     }
-    return Node(std::move(dict));
+    return pos;
 }
 
-Node LoadString(std::istream& input) {
-    auto it = std::istreambuf_iterator<char>(input);
-    auto end = std::istreambuf_iterator<char>();
-    std::string s;
-    while (true) {
-        if (it == end) {
-            throw ParsingError("String parsing error"s);
-        }
-        const char ch = *it;
-        if (ch == '"') {
-            ++it;
-            break;
+// Источник данных для разбора: весь текст в одном непрерывном буфере
+class BufferSource {
+public:
+    explicit BufferSource(std::string_view input)
+        : pos(input.data())
+        , end(input.data() + input.size()) {
+    }
+
+    bool Refill() {
+        return false;
+    }
+
+    const char* pos;
+    const char* end;
+};
+
+// Источник данных для разбора: поток, читаемый блоками.
+// После Refill прежние указатели в буфер недействительны.
+class StreamSource {
+public:
+    explicit StreamSource(std::istream& input)
+        : input_(input) {
+    }
+
+    // Берёт из буфера потока только то, что в нём уже лежит: тогда прочитанное
+    // за концом документа можно вернуть в поток (GiveBack). Поток без своего
+    // буфера читается блоками целиком.
+    bool Refill() {
+        std::streambuf* const buffer = input_.rdbuf();
+        pos = end = buffer_;
+        if (std::char_traits<char>::eq_int_type(buffer->sgetc(), std::char_traits<char>::eof())) {
+            input_.setstate(std::ios::eofbit);
+            return false;
         }
-        else if (ch == '\\') {
-            ++it;
-            if (it == end) {
-                throw ParsingError("String parsing error"s);
-            }
-            const char escaped_char = *(it);
-            switch (escaped_char) {
-            case 'n':
-                s.push_back('\n');
-                break;
-            case 't':
-                s.push_back('\t');
-                break;
-            case 'r':
-                s.push_back('\r');
-                break;
-            case '"':
-                s.push_back('"');
-                break;
-            case '\\':
-                s.push_back('\\');
+        const std::streamsize available = buffer->in_avail();
+        const std::streamsize size = available > 0
+            ? std::min<std::streamsize>(available, sizeof(buffer_))
+            : static_cast<std::streamsize>(sizeof(buffer_));
+        end = buffer_ + buffer->sgetn(buffer_, size);
+        return pos != end;
+    }
+
+    // Возвращает в поток непрочитанный остаток блока. Сначала символы кладутся
+    // обратно в буфер потока, затем поток перематывается. Если не удаётся ни то,
+    // ни другое (поток без буфера и без позиционирования), остаток теряется.
+    void GiveBack() {
+        std::streambuf* const buffer = input_.rdbuf();
+        while (end != pos) {
+            if (std::char_traits<char>::eq_int_type(buffer->sputbackc(end[-1]), std::char_traits<char>::eof())) {
                 break;
-            default:
-                throw ParsingError("Unrecognized escape sequence \\"s + escaped_char);
             }
+            --end;
         }
-        else if (ch == '\n' || ch == '\r') {
-            throw ParsingError("Unexpected end of line"s);
+        if (end != pos) {
+            const auto rest = static_cast<std::streamoff>(end - pos);
+            if (buffer->pubseekoff(-rest, std::ios::cur, std::ios::in) != std::streampos(std::streamoff(-1))) {
+                end = pos;
+            }
         }
-        else {
-            s.push_back(ch);
+        if (pos == end) {
+            // Остаток вернулся: конец потока ещё не достигнут
+            input_.clear(input_.rdstate() & ~std::ios::eofbit);
         }
-        ++it;
     }
 
-    return Node(std::move(s));
-}
+    const char* pos = nullptr;
+    const char* end = nullptr;
 
-Node LoadBool(std::istream& input) {
-    const auto s = LoadLiteral(input);
-    if (s == "true"sv) {
-        return Node{ true };
-    }
-    else if (s == "false"sv) {
-        return Node{ false };
-    }
-    else {
-        throw ParsingError("Failed to parse '"s + s + "' as bool"s);
+private:
+    std::istream& input_;
+    char buffer_[1 << 16];
+};
+
+// Потоковый разбор без рекурсии. Вложенность хранится в стеке из символов '{' и '[',
+// поэтому память ограничена размером блока источника, длиной самого длинного
+// значения и глубиной вложенности.
+template <typename Source, typename Handler>
+class Parser {
+public:
+    Parser(Source& source, Handler& handler)
+        : src_(source)
+        , handler_(handler) {
     }
-}
 
-Node LoadNull(std::istream& input) {
-    if (auto literal = LoadLiteral(input); literal == "null"sv) {
-        return Node{ nullptr };
+    void Parse() {
+        ParseValue();
+        while (!stack_.empty()) {
+            // Первый элемент только что открытого массива
+            if (expect_value_) {
+                expect_value_ = false;
+                ParseValue();
+                continue;
+            }
+
+            const char c = NextSignificant();
+            if (stack_.back() == '[') {
+                if (c == ']') {
+                    stack_.pop_back();
+                    handler_.EndArray();
+                }
+                else if (c == ',') {
+                    ParseValue();
+                }
+                else {
+                    throw ParsingError(R"(',' is expected but ')"s + c + "' has been found"s);
+                }
+            }
+            else {
+                if (c == '}') {
+                    stack_.pop_back();
+                    handler_.EndObject();
+                }
+                else if (c == ',') {
+                    // Как и прежний загрузчик, допускаем запятую перед '}'
+                    if (const char next = NextSignificant(); next == '}') {
+                        stack_.pop_back();
+                        handler_.EndObject();
+                    }
+                    else {
+                        ParseMember(next);
+                    }
+                }
+                else {
+                    throw ParsingError(R"(',' is expected but ')"s + c + "' has been found"s);
+                }
+            }
+        }
     }
-    else {
-        throw ParsingError("Failed to parse '"s + literal + "' as null"s);
+
+private:
+    bool HasData() {
+        return src_.pos != src_.end || src_.Refill();
     }
-}
 
-Node LoadNumber(std::istream& input) {
-    std::string parsed_num;
+    bool SkipWhitespace() {
+        // Обычно за значением следует не больше одного пробела, проверяем его сразу
+        if (src_.pos != src_.end && !IsSpace(*src_.pos)) {
+            return true;
+        }
+        while (HasData()) {
+            src_.pos = SkipSpaces(src_.pos, src_.end);
+            if (src_.pos != src_.end) {
+                return true;
+            }
+        }
+        return false;
+    }
 
-    // Считывает в parsed_num очередной символ из input
-    auto read_char = [&parsed_num, &input] {
-        parsed_num += static_cast<char>(input.get());
-        if (!input) {
-            throw ParsingError("Failed to read number from stream"s);
+    char NextSignificant() {
+        if (!SkipWhitespace()) {
+            throw ParsingError(!stack_.empty() && stack_.back() == '[' ? "Array parsing error"s : "Dictionary parsing error"s);
         }
-    };
+        return *src_.pos++;
+    }
 
-    // Считывает одну или более цифр в parsed_num из input
-    auto read_digits = [&input, read_char] {
-        if (!std::isdigit(input.peek())) {
-            throw ParsingError("A digit is expected"s);
+    void ParseValue() {
+        if (!SkipWhitespace()) {
+            throw ParsingError("Unexpected EOF"s);
         }
-        while (std::isdigit(input.peek())) {
-            read_char();
+        switch (*src_.pos) {
+        case '[':
+            ++src_.pos;
+            handler_.StartArray();
+            if (!SkipWhitespace()) {
+                throw ParsingError("Array parsing error"s);
+            }
+            if (*src_.pos == ']') {
+                ++src_.pos;
+                handler_.EndArray();
+            }
+            else {
+                stack_.push_back('[');
+                expect_value_ = true;
+            }
+            break;
+        case '{':
+            ++src_.pos;
+            handler_.StartObject();
+            if (const char c = NextSignificant(); c == '}') {
+                handler_.EndObject();
+            }
+            else {
+                stack_.push_back('{');
+                ParseMember(c);
+            }
+            break;
+        case '"':
+            ++src_.pos;
+            handler_.String(ParseString());
+            break;
+        case 't':
+            [[fallthrough]];
+        case 'f':
+            ParseBool();
+            break;
+        case 'n':
+            ParseNull();
+            break;
+        default:
+            ParseNumber();
         }
-    };
+    }
 
-    if (input.peek() == '-') {
-        read_char();
+    // Разбирает пару "ключ": значение, c - уже прочитанный первый символ
+    void ParseMember(char c) {
+        if (c != '"') {
+            throw ParsingError(R"(',' is expected but ')"s + c + "' has been found"s);
+        }
+        handler_.Key(ParseString());
+        if (!SkipWhitespace() || *src_.pos != ':') {
+            throw ParsingError(": is expected but '"s + (src_.pos == src_.end ? ""s : std::string(1, *src_.pos)) + "' has been found"s);
+        }
+        ++src_.pos;
+        ParseValue();
     }
-    // Парсим целую часть числа
-    if (input.peek() == '0') {
-        read_char();
-        // После 0 в JSON не могут идти другие цифры
+
+    // Разбирает строку после открывающей кавычки. Участки без экранирования
+    // находятся векторным поиском и копируются целиком. Строка без экранирования,
+    // целиком лежащая в текущем блоке, возвращается без копирования.
+    std::string_view ParseString() {
+        bool buffered = false;
+        const char* run = src_.pos;
+
+        auto flush = [&] {
+            if (!buffered) {
+                scratch_.clear();
+                buffered = true;
+            }
+            scratch_.append(run, src_.pos);
+        };
+
+        while (true) {
+            if (src_.pos == src_.end) {
+                flush();
+                if (!src_.Refill()) {
+                    throw ParsingError("String parsing error"s);
+                }
+                run = src_.pos;
+            }
+            src_.pos = FindStringSpecial(src_.pos, src_.end);
+            if (src_.pos == src_.end) {
+                continue;
+            }
+            const char ch = *src_.pos;
+            if (ch == '"') {
+                if (!buffered) {
+                    return { run, static_cast<size_t>(src_.pos++ - run) };
+                }
+                flush();
+                ++src_.pos;
+                return scratch_;
+            }
+            else if (ch == '\\') {
+                flush();
+                ++src_.pos;
+                if (!HasData()) {
+                    throw ParsingError("String parsing error"s);
+                }
+                const char escaped_char = *src_.pos;
+                switch (escaped_char) {
+                case 'n':
+                    scratch_.push_back('\n');
+                    break;
+                case 't':
+                    scratch_.push_back('\t');
+                    break;
+                case 'r':
+                    scratch_.push_back('\r');
+                    break;
+                case '"':
+                    scratch_.push_back('"');
+                    break;
+                case '\\':
+                    scratch_.push_back('\\');
+                    break;
+                default:
+                    throw ParsingError("Unrecognized escape sequence \\"s + escaped_char);
+                }
+                run = ++src_.pos;
+            }
+            else if (ch == '\n' || ch == '\r') {
+                throw ParsingError("Unexpected end of line"s);
+            }
+            else {
+                ++src_.pos;
+            }
+        }
     }
-    else {
-        read_digits();
+
+    // Считывает подряд идущие символы, удовлетворяющие pred.
+    // Если значение разорвано границей блока, оно собирается в scratch_.
+    template <typename Pred>
+    std::string_view ReadToken(Pred pred) {
+        bool buffered = false;
+        const char* begin = src_.pos;
+        while (true) {
+            while (src_.pos != src_.end && pred(*src_.pos)) {
+                ++src_.pos;
+            }
+            if (src_.pos != src_.end) {
+                break;
+            }
+            if (!buffered) {
+                scratch_.clear();
+                buffered = true;
+            }
+            scratch_.append(begin, src_.pos);
+            if (!src_.Refill()) {
+                return scratch_;
+            }
+            begin = src_.pos;
+        }
+        if (!buffered) {
+            return { begin, static_cast<size_t>(src_.pos - begin) };
+        }
+        scratch_.append(begin, src_.pos);
+        return scratch_;
     }
 
-    bool is_int = true;
-    // Парсим дробную часть числа
-    if (input.peek() == '.') {
-        read_char();
-        read_digits();
-        is_int = false;
+    void ParseBool() {
+        const auto s = ReadToken(IsAlpha);
+        if (s == "true"sv) {
+            handler_.Bool(true);
+        }
+        else if (s == "false"sv) {
+            handler_.Bool(false);
+        }
+        else {
+            throw ParsingError("Failed to parse '"s + std::string(s) + "' as bool"s);
+        }
     }
 
-    // Парсим экспоненциальную часть числа
-    if (int ch = input.peek(); ch == 'e' || ch == 'E') {
-        read_char();
-        if (ch = input.peek(); ch == '+' || ch == '-') {
-            read_char();
+    void ParseNull() {
+        if (auto literal = ReadToken(IsAlpha); literal == "null"sv) {
+            handler_.Null();
+        }
+        else {
+            throw ParsingError("Failed to parse '"s + std::string(literal) + "' as null"s);
         }
-        read_digits();
-        is_int = false;
     }
 
-    try {
-        if (is_int) {
-            // Сначала пробуем преобразовать строку в int
-            try {
-                return std::stoi(parsed_num);
+    // Проверяет синтаксис числа и преобразует его на месте через std::from_chars
+    void ParseNumber() {
+        const std::string_view token = ReadToken(IsNumberChar);
+        const char* pos = token.data();
+        const char* end = token.data() + token.size();
+
+        auto read_digits = [&pos, end] {
+            if (pos == end || !IsDigit(*pos)) {
+                throw ParsingError("A digit is expected"s);
             }
-            catch (...) {
-                // В случае неудачи, например, при переполнении
-                // код ниже попробует преобразовать строку в double
+            while (pos != end && IsDigit(*pos)) {
+                ++pos;
             }
+        };
+
+        if (pos != end && *pos == '-') {
+            ++pos;
+        }
+        // Парсим целую часть числа
+        if (pos != end && *pos == '0') {
+            ++pos;
+            // После 0 в JSON не могут идти другие цифры
+        }
+        else {
+            read_digits();
+        }
+
+        bool is_int = true;
+        // Парсим дробную часть числа
+        if (pos != end && *pos == '.') {
+            ++pos;
+            read_digits();
+            is_int = false;
         }
-        return std::stod(parsed_num);
+
+        // Парсим экспоненциальную часть числа
+        if (pos != end && (*pos == 'e' || *pos == 'E')) {
+            ++pos;
+            if (pos != end && (*pos == '+' || *pos == '-')) {
+                ++pos;
+            }
+            read_digits();
+            is_int = false;
+        }
+
+        if (pos != end) {
+            throw ParsingError("Failed to convert "s + std::string(token) + " to number"s);
+        }
+
+        if (is_int) {
+            // Сначала пробуем преобразовать строку в int. При переполнении
+            // код ниже преобразует строку в double
+            int value = 0;
+            if (auto [ptr, ec] = std::from_chars(token.data(), end, value); ec == std::errc() && ptr == end) {
+                handler_.Int(value);
+                return;
+            }
+        }
+
+        double value = 0.0;
+        if (auto [ptr, ec] = std::from_chars(token.data(), end, value); ec != std::errc() || ptr != end) {
+            throw ParsingError("Failed to convert "s + std::string(token) + " to number"s);
+        }
+        handler_.Double(value);
     }
-    catch (...) {
-        throw ParsingError("Failed to convert "s + parsed_num + " to number"s);
+
+private:
+    Source& src_;
+    Handler& handler_;
+    std::vector<char> stack_;
+    bool expect_value_ = false;
+    std::string scratch_;
+};
+
+template <typename Handler>
+void ParseStream(std::istream& input, Handler& handler) {
+    auto source = std::make_unique<StreamSource>(input);
+    Parser<StreamSource, Handler>(*source, handler).Parse();
+    source->GiveBack();
+}
+
+template <typename Handler>
+void ParseBuffer(std::string_view input, Handler& handler) {
+    BufferSource source(input);
+    Parser<BufferSource, Handler>(source, handler).Parse();
+}
+
+}  // namespace
+
+//----------------- DomBuilder -----------------------
+
+DomBuilder::DomBuilder(std::pmr::memory_resource* resource)
+    : resource_(resource) {
+}
+
+void DomBuilder::Null() {
+    AddValue(nullptr);
+}
+
+void DomBuilder::Bool(bool value) {
+    AddValue(value);
+}
+
+void DomBuilder::Int(int value) {
+    AddValue(value);
+}
+
+void DomBuilder::Double(double value) {
+    AddValue(value);
+}
+
+void DomBuilder::String(std::string_view value) {
+    AddValue(SmallString(value, resource_));
+}
+
+void DomBuilder::StartObject() {
+    stack_.push_back({ values_.size(), keys_.size() });
+}
+
+void DomBuilder::Key(std::string_view key) {
+    keys_.emplace_back(key, resource_);
+}
+
+void DomBuilder::EndObject() {
+    using namespace std::literals;
+    const Frame frame = stack_.back();
+    stack_.pop_back();
+
+    Dict dict(resource_);
+    dict.reserve(values_.size() - frame.values_begin);
+    for (size_t i = 0; frame.values_begin + i < values_.size(); ++i) {
+        const auto [it, inserted] = dict.emplace(std::move(keys_[frame.keys_begin + i]),
+            std::move(values_[frame.values_begin + i]));
+        if (!inserted) {
+            throw ParsingError("Duplicate key '"s + std::string(it->first.View()) + "' have been found"s);
+        }
     }
+    values_.resize(frame.values_begin);
+    keys_.resize(frame.keys_begin);
+    AddValue(std::move(dict));
+}
+
+void DomBuilder::StartArray() {
+    stack_.push_back({ values_.size(), keys_.size() });
+}
+
+void DomBuilder::EndArray() {
+    const Frame frame = stack_.back();
+    stack_.pop_back();
+
+    Array array(resource_);
+    array.reserve(values_.size() - frame.values_begin);
+    std::move(values_.begin() + frame.values_begin, values_.end(), std::back_inserter(array));
+    values_.resize(frame.values_begin);
+    AddValue(std::move(array));
 }
 
-Node LoadNode(std::istream& input) {
-    char c;
-    if (!(input >> c)) {
-        throw ParsingError("Unexpected EOF"s);
+Node DomBuilder::Extract() {
+    return std::move(root_);
+}
+
+void DomBuilder::AddValue(Node value) {
+    if (stack_.empty()) {
+        root_ = std::move(value);
     }
-    switch (c) {
-    case '[':
-        return LoadArray(input);
-    case '{':
-        return LoadDict(input);
-    case '"':
-        return LoadString(input);
-    case 't':
-        // Атрибут [[fallthrough]] (провалиться) ничего не делает, и является
-        // подсказкой компилятору и человеку, что здесь программист явно задумывал
-        // разрешить переход к инструкции следующей ветки case, а не случайно забыл
-        // написать break, return или throw.
-        // В данном случае, встретив t или f, переходим к попытке парсинга
-        // литералов true либо false
-        [[fallthrough]];
-    case 'f':
-        input.putback(c);
-        return LoadBool(input);
-    case 'n':
-        input.putback(c);
-        return LoadNull(input);
-    default:
-        input.putback(c);
-        return LoadNumber(input);
+    else {
+        values_.push_back(std::move(value));
     }
 }
 
-struct PrintContext {
-    std::ostream& out;
-    int indent_step = 4;
-    int indent = 0;
+//----------------- Writer -----------------------
 
-    void PrintIndent() const {
-        for (int i = 0; i < indent; ++i) {
-            out.put(' ');
-        }
+Writer::Writer(std::ostream& output, PrintSettings settings)
+    : output_(output)
+    , settings_(settings) {
+    buffer_.reserve(kFlushThreshold + kFlushThreshold / 4);
+}
+
+Writer::~Writer() {
+    Flush();
+}
+
+void Writer::Null() {
+    using namespace std::literals;
+    BeforeValue();
+    Write("null"sv);
+}
+
+void Writer::Bool(bool value) {
+    using namespace std::literals;
+    BeforeValue();
+    Write(value ? "true"sv : "false"sv);
+}
+
+void Writer::Int(int value) {
+    BeforeValue();
+    char buffer[16];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    Write({ buffer, static_cast<size_t>(result.ptr - buffer) });
+}
+
+void Writer::Double(double value) {
+    BeforeValue();
+    // Кратчайшее представление, которое читается обратно в то же значение
+    char buffer[32];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    Write({ buffer, static_cast<size_t>(result.ptr - buffer) });
+}
+
+void Writer::String(std::string_view value) {
+    BeforeValue();
+    WriteString(value);
+}
+
+void Writer::StartObject() {
+    BeforeValue();
+    buffer_.push_back('{');
+    levels_.push_back(true);
+}
+
+void Writer::Key(std::string_view key) {
+    BeforeItem();
+    WriteString(key);
+    buffer_.push_back(':');
+    if (!settings_.compact) {
+        buffer_.push_back(' ');
+    }
+    after_key_ = true;
+}
+
+void Writer::EndObject() {
+    EndContainer('}');
+}
+
+void Writer::StartArray() {
+    BeforeValue();
+    buffer_.push_back('[');
+    levels_.push_back(true);
+}
+
+void Writer::EndArray() {
+    EndContainer(']');
+}
+
+void Writer::Flush() {
+    if (!buffer_.empty()) {
+        output_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+        flushed_ += buffer_.size();
+        buffer_.clear();
     }
+}
 
-    PrintContext Indented() const {
-        return { out, indent_step, indent_step + indent };
+size_t Writer::GetBytesWritten() const {
+    return flushed_ + buffer_.size();
+}
+
+void Writer::BeforeValue() {
+    if (after_key_) {
+        after_key_ = false;
+        return;
     }
-};
+    if (!levels_.empty()) {
+        BeforeItem();
+    }
+}
+
+// Разделитель и отступ перед элементом массива или ключом словаря
+void Writer::BeforeItem() {
+    if (buffer_.size() >= kFlushThreshold) {
+        Flush();
+    }
+    if (levels_.back()) {
+        levels_.back() = false;
+    }
+    else {
+        buffer_.push_back(',');
+    }
+    if (!settings_.compact) {
+        buffer_.push_back('\n');
+        buffer_.append(levels_.size() * settings_.indent_step, ' ');
+    }
+}
 
-void PrintNode(const Node& value, const PrintContext& ctx);
+void Writer::EndContainer(char bracket) {
+    const bool empty = levels_.back();
+    levels_.pop_back();
+    if (!settings_.compact && !empty) {
+        buffer_.push_back('\n');
+        buffer_.append(levels_.size() * settings_.indent_step, ' ');
+    }
+    buffer_.push_back(bracket);
+}
 
-template <typename Value>
-void PrintValue(const Value& value, const PrintContext& ctx) {
-    ctx.out << value;
+void Writer::Write(std::string_view text) {
+    buffer_.append(text);
 }
 
-void PrintString(const std::string& value, std::ostream& out) {
-    out.put('"');
-    for (const char c : value) {
-        switch (c) {
+// Символы " и \ выводятся как \" и \\, переводы строк - как \n и \r.
+// Участки между ними копируются целиком.
+void Writer::WriteString(std::string_view value) {
+    buffer_.push_back('"');
+    const char* pos = value.data();
+    const char* end = value.data() + value.size();
+    while (pos != end) {
+        const char* special = FindStringSpecial(pos, end);
+        buffer_.append(pos, special);
+        if (special == end) {
+            break;
+        }
+        switch (*special) {
         case '\r':
-            out << "\\r"sv;
+            buffer_.append("\\r");
             break;
         case '\n':
-            out << "\\n"sv;
+            buffer_.append("\\n");
             break;
         case '"':
-            // Символы " и \ выводятся как \" или \\, соответственно
             [[fallthrough]];
         case '\\':
-            out.put('\\');
+            buffer_.push_back('\\');
             [[fallthrough]];
         default:
-            out.put(c);
+            buffer_.push_back(*special);
             break;
         }
+        pos = special + 1;
     }
-    out.put('"');
+    buffer_.push_back('"');
+    if (buffer_.size() >= kFlushThreshold) {
+        Flush();
+    }
+}
+
+//----------------- Node Printer -----------------------
+
+namespace {
+
+template <typename Handler>
+void PrintNode(const Node& node, Handler& writer);
+
+template <typename Handler>
+void PrintValue(std::nullptr_t, Handler& writer) {
+    writer.Null();
 }
 
-template <>
-void PrintValue<std::string>(const std::string& value, const PrintContext& ctx) {
-    PrintString(value, ctx.out);
+template <typename Handler>
+void PrintValue(bool value, Handler& writer) {
+    writer.Bool(value);
 }
 
-template <>
-void PrintValue<std::nullptr_t>(const std::nullptr_t&, const PrintContext& ctx) {
-    ctx.out << "null"sv;
+template <typename Handler>
+void PrintValue(int value, Handler& writer) {
+    writer.Int(value);
 }
 
-// В специализаци шаблона PrintValue для типа bool параметр value передаётся
-// по константной ссылке, как и в основном шаблоне.
-// В качестве альтернативы можно использовать перегрузку:
-// void PrintValue(bool value, const PrintContext& ctx);
-template <>
-void PrintValue<bool>(const bool& value, const PrintContext& ctx) {
-    ctx.out << (value ? "true"sv : "false"sv);
+template <typename Handler>
+void PrintValue(double value, Handler& writer) {
+    writer.Double(value);
 }
 
-template <>
-void PrintValue<Array>(const Array& nodes, const PrintContext& ctx) {
-    std::ostream& out = ctx.out;
-    out << "[\n"sv;
-    bool first = true;
-    auto inner_ctx = ctx.Indented();
+template <typename Handler>
+void PrintValue(const SmallString& value, Handler& writer) {
+    writer.String(value);
+}
+
+template <typename Handler>
+void PrintValue(const Array& nodes, Handler& writer) {
+    writer.StartArray();
     for (const Node& node : nodes) {
-        if (first) {
-            first = false;
-        }
-        else {
-            out << ",\n"sv;
-        }
-        inner_ctx.PrintIndent();
-        PrintNode(node, inner_ctx);
+        PrintNode(node, writer);
     }
-    out.put('\n');
-    ctx.PrintIndent();
-    out.put(']');
+    writer.EndArray();
 }
 
-template <>
-void PrintValue<Dict>(const Dict& nodes, const PrintContext& ctx) {
-    std::ostream& out = ctx.out;
-    out << "{\n"sv;
-    bool first = true;
-    auto inner_ctx = ctx.Indented();
+template <typename Handler>
+void PrintValue(const Dict& nodes, Handler& writer) {
+    writer.StartObject();
     for (const auto& [key, node] : nodes) {
-        if (first) {
-            first = false;
-        }
-        else {
-            out << ",\n"sv;
-        }
-        inner_ctx.PrintIndent();
-        PrintString(key, ctx.out);
-        out << ": "sv;
-        PrintNode(node, inner_ctx);
+        writer.Key(key);
+        PrintNode(node, writer);
     }
-    out.put('\n');
-    ctx.PrintIndent();
-    out.put('}');
+    writer.EndObject();
 }
 
-void PrintNode(const Node& node, const PrintContext& ctx) {
+template <typename Handler>
+void PrintNode(const Node& node, Handler& writer) {
     std::visit(
-        [&ctx](const auto& value) {
-            PrintValue(value, ctx);
+        [&writer](const auto& value) {
+            PrintValue(value, writer);
         },
         node.GetValue());
 }
@@ -459,6 +1321,48 @@ Document::Document(Node root)
     : root_(std::move(root)) {
 }
 
+Document::Document(Node root, std::pmr::memory_resource&)
+    : root_(std::move(root))
+    , in_arena_(true) {
+}
+
+// Копия размещается в ресурсе по умолчанию и не зависит от арены
+Document::Document(const Document& other)
+    : root_(other.root_) {
+}
+
+Document::Document(Document&& other) noexcept
+    : root_(std::move(other.root_))
+    , in_arena_(other.in_arena_) {
+}
+
+Document& Document::operator=(const Document& other) {
+    if (this != &other) {
+        Document copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+Document& Document::operator=(Document&& other) noexcept {
+    if (this != &other) {
+        Destroy();
+        new (&root_) Node(std::move(other.root_));
+        in_arena_ = other.in_arena_;
+    }
+    return *this;
+}
+
+Document::~Document() {
+    Destroy();
+}
+
+void Document::Destroy() noexcept {
+    if (!in_arena_) {
+        root_.~Node();
+    }
+}
+
 const Node& Document::GetRoot() const {
     return root_;
 }
@@ -472,11 +1376,101 @@ inline bool operator!=(const Document& lhs, const Document& rhs) {
 }
 
 Document Load(std::istream& input) {
-    return Document{ LoadNode(input) };
+    DomBuilder builder;
+    ParseStream(input, builder);
+    return Document{ builder.Extract() };
+}
+
+Document Load(std::string_view input) {
+    DomBuilder builder;
+    ParseBuffer(input, builder);
+    return Document{ builder.Extract() };
+}
+
+Document Load(std::istream& input, std::pmr::memory_resource& arena) {
+    DomBuilder builder(&arena);
+    ParseStream(input, builder);
+    return Document{ builder.Extract(), arena };
+}
+
+Document Load(std::string_view input, std::pmr::memory_resource& arena) {
+    DomBuilder builder(&arena);
+    ParseBuffer(input, builder);
+    return Document{ builder.Extract(), arena };
+}
+
+Document LoadFile(const std::string& path) {
+#if defined(__unix__) || defined(__APPLE__)
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw ParsingError("Failed to open "s + path);
+    }
+    struct stat st {};
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        throw ParsingError("Failed to stat "s + path);
+    }
+    if (st.st_size == 0) {
+        close(fd);
+        return Load(std::string_view{});
+    }
+
+    void* data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        throw ParsingError("Failed to map "s + path);
+    }
+
+    try {
+        Document result = Load(std::string_view(static_cast<const char*>(data), static_cast<size_t>(st.st_size)));
+        munmap(data, static_cast<size_t>(st.st_size));
+        return result;
+    }
+    catch (...) {
+        munmap(data, static_cast<size_t>(st.st_size));
+        throw;
+    }
+#else
+    std::ifstream input(path, std::ios::binary);
+    if (!input) {
+        throw ParsingError("Failed to open "s + path);
+    }
+    return Load(input);
+#endif
+}
+
+void Parse(std::istream& input, EventHandler& handler) {
+    ParseStream(input, handler);
+}
+
+void Parse(std::string_view input, EventHandler& handler) {
+    ParseBuffer(input, handler);
+}
+
+std::string ReadAll(std::istream& input) {
+    std::string result;
+    char buffer[1 << 16];
+    while (input.read(buffer, sizeof(buffer)) || input.gcount() > 0) {
+        result.append(buffer, static_cast<size_t>(input.gcount()));
+    }
+    return result;
 }
 
 void Print(const Document& doc, std::ostream& output) {
-    PrintNode(doc.GetRoot(), PrintContext{ output });
+    Print(doc, output, PrintSettings{});
+}
+
+void Print(const Document& doc, std::ostream& output, PrintSettings settings) {
+    Writer writer(output, settings);
+    PrintNode(doc.GetRoot(), writer);
+}
+
+void Print(const Node& node, Writer& writer) {
+    PrintNode(node, writer);
+}
+
+void Emit(const Node& node, EventHandler& handler) {
+    PrintNode(node, handler);
 }
 
 }  // namespace json
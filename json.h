@@ -1,26 +1,170 @@
 #pragma once
 
+#include <cstdint>
+#include <cstring>
 #include <iostream>
-#include <map>
+#include <memory_resource>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <variant>
 #include <vector>
 
 namespace json {
 
 class Node;
-using Dict = std::map<std::string, Node>;
-using Array = std::vector<Node>;
 
 class ParsingError : public std::runtime_error {
 public:
     using runtime_error::runtime_error;
 };
 
+//----------------- SmallString -----------------------
+
+// Строка размером 16 байт. До 15 символов хранятся внутри объекта,
+// более длинные размещаются в memory_resource (по умолчанию - в куче).
+// Как и у std::pmr-контейнеров, копия использует ресурс по умолчанию.
+class SmallString {
+public:
+    SmallString() noexcept;
+    SmallString(std::string_view value);
+    SmallString(std::string_view value, std::pmr::memory_resource* resource);
+    SmallString(const std::string& value);
+    SmallString(const char* value);
+    SmallString(const SmallString& other);
+    SmallString(SmallString&& other) noexcept;
+    SmallString& operator=(const SmallString& other);
+    SmallString& operator=(SmallString&& other) noexcept;
+    ~SmallString();
+
+public:
+    std::string_view View() const noexcept {
+        if (IsLong()) {
+            const char* ptr;
+            uint32_t size;
+            std::memcpy(&ptr, data_, sizeof(ptr));
+            std::memcpy(&size, data_ + sizeof(ptr), sizeof(size));
+            return { ptr, size };
+        }
+        return { data_, static_cast<size_t>(kInlineCapacity - data_[kInlineCapacity]) };
+    }
+
+    operator std::string_view() const noexcept {
+        return View();
+    }
+
+    size_t size() const noexcept {
+        return View().size();
+    }
+
+    bool operator==(const SmallString& rhs) const noexcept {
+        return View() == rhs.View();
+    }
+
+    bool operator!=(const SmallString& rhs) const noexcept {
+        return !(*this == rhs);
+    }
+
+private:
+    static constexpr size_t kInlineCapacity = 15;
+    // Значение последнего байта, отмечающее строку в куче
+    static constexpr char kLongTag = static_cast<char>(0xFF);
+
+    bool IsLong() const noexcept {
+        return data_[kInlineCapacity] == kLongTag;
+    }
+
+    void Assign(std::string_view value, std::pmr::memory_resource* resource);
+    void Release() noexcept;
+
+private:
+    // Короткая строка: символы в начале, в последнем байте kInlineCapacity - длина.
+    // Длинная: указатель, длина (uint32_t) и kLongTag в последнем байте.
+    // Перед символами длинной строки хранится указатель на её memory_resource.
+    alignas(8) char data_[kInlineCapacity + 1];
+};
+
+//----------------- Array & Dict -----------------------
+
+using Array = std::pmr::vector<Node>;
+
+// Словарь в виде непрерывного массива пар в порядке вставки.
+// Поиск не создаёт временных строк. В запросах обычно несколько ключей,
+// и для них просмотр массива быстрее обхода дерева; для больших словарей
+// (например, road_distances) строится хэш-индекс номеров пар.
+class Dict {
+public:
+    using key_type = SmallString;
+    using mapped_type = Node;
+    using value_type = std::pair<SmallString, Node>;
+    using iterator = value_type*;
+    using const_iterator = const value_type*;
+
+public:
+    Dict() = default;
+    explicit Dict(std::pmr::memory_resource* resource);
+    // Как и у std::pmr-контейнеров, копия размещается в ресурсе по умолчанию
+    Dict(const Dict& other);
+    Dict(Dict&& other) noexcept;
+    Dict& operator=(const Dict& other);
+    Dict& operator=(Dict&& other);
+    ~Dict();
+
+public:
+    iterator begin() noexcept;
+    iterator end() noexcept;
+    const_iterator begin() const noexcept;
+    const_iterator end() const noexcept;
+
+    size_t size() const noexcept;
+    bool empty() const noexcept;
+    void reserve(size_t size);
+
+    iterator find(std::string_view key);
+    const_iterator find(std::string_view key) const;
+    size_t count(std::string_view key) const;
+
+    // Бросает std::out_of_range, если ключа нет
+    Node& at(std::string_view key);
+    const Node& at(std::string_view key) const;
+
+    Node& operator[](std::string_view key);
+
+    // Добавляет пару, если такого ключа ещё нет. Ключ ищется один раз.
+    std::pair<iterator, bool> emplace(SmallString key, Node value);
+
+    bool operator==(const Dict& rhs) const;
+    bool operator!=(const Dict& rhs) const;
+
+private:
+    // Словари не больше этого размера обходятся без индекса
+    static constexpr uint32_t kIndexThreshold = 8u;
+
+    static uint32_t GetIndexSize(uint32_t capacity) noexcept;
+
+    // Номер пары с ключом key или size_. При наличии индекса в slot
+    // записывается его ячейка с этим ключом или свободная ячейка для него.
+    uint32_t Lookup(std::string_view key, uint32_t*& slot) const noexcept;
+    // Добавляет пару с ключом, которого нет; slot - результат Lookup
+    iterator Append(SmallString&& key, Node&& value, uint32_t* slot);
+    void Grow(uint32_t capacity);
+    void BuildIndex() noexcept;
+    void Release() noexcept;
+
+private:
+    value_type* items_ = nullptr;
+    uint32_t size_ = 0u;
+    uint32_t capacity_ = 0u;
+    std::pmr::memory_resource* resource_ = std::pmr::get_default_resource();
+    // Открытая адресация: номер пары + 1 или 0 в свободной ячейке.
+    // Число ячеек - GetIndexSize(capacity_), индекса нет у небольших словарей.
+    uint32_t* index_ = nullptr;
+};
+
 //----------------- Node -----------------------
 
 class Node final
-    : private std::variant<std::nullptr_t, Array, Dict, bool, int, double, std::string> {
+    : private std::variant<std::nullptr_t, Array, Dict, bool, int, double, SmallString> {
 public:
     using variant::variant;
     using Value = variant;
@@ -42,7 +186,7 @@ public:
     const Array& AsArray() const;
 
     bool IsString() const;
-    const std::string& AsString() const;
+    std::string_view AsString() const;
 
     bool IsDict() const;
     const Dict& AsDict() const;
@@ -50,6 +194,7 @@ public:
     bool operator==(const Node& rhs) const;
 
     const Value& GetValue() const;
+    Value& GetValue();
 };
 
 inline bool operator!=(const Node& lhs, const Node& rhs);
@@ -59,20 +204,168 @@ inline bool operator!=(const Node& lhs, const Node& rhs);
 class Document {
 public:
     explicit Document(Node root);
+    // Документ, все узлы которого размещены в арене. Деструктор не обходит дерево:
+    // память освобождается целиком вместе с ареной, которая должна пережить документ.
+    Document(Node root, std::pmr::memory_resource& arena);
+
+    Document(const Document& other);
+    Document(Document&& other) noexcept;
+    Document& operator=(const Document& other);
+    Document& operator=(Document&& other) noexcept;
+    ~Document();
 
 public:
     const Node& GetRoot() const;
 
 private:
-    Node root_;
+    void Destroy() noexcept;
+
+private:
+    union {
+        Node root_;
+    };
+    bool in_arena_ = false;
 };
 
 inline bool operator==(const Document& lhs, const Document& rhs);
 
 inline bool operator!=(const Document& lhs, const Document& rhs);
 
+//----------------- Event parser -----------------------
+
+// Обработчик событий потокового разбора. Строки и ключи передаются
+// представлениями, действительными только до возврата из обработчика.
+class EventHandler {
+public:
+    virtual void Null() = 0;
+    virtual void Bool(bool value) = 0;
+    virtual void Int(int value) = 0;
+    virtual void Double(double value) = 0;
+    virtual void String(std::string_view value) = 0;
+    virtual void StartObject() = 0;
+    virtual void Key(std::string_view key) = 0;
+    virtual void EndObject() = 0;
+    virtual void StartArray() = 0;
+    virtual void EndArray() = 0;
+
+protected:
+    ~EventHandler() = default;
+};
+
+// Поток читается блоками, полностью в память он не загружается. Символы,
+// прочитанные за концом документа, возвращаются в поток, и вызывающий может
+// читать дальше. Это невозможно только для потока без буфера и без
+// позиционирования (например, std::cin из канала при sync_with_stdio(true)):
+// тогда остаток последнего блока теряется.
+void Parse(std::istream& input, EventHandler& handler);
+void Parse(std::string_view input, EventHandler& handler);
+
+// Собирает дерево Node из событий разбора. Контейнеры и длинные строки
+// размещаются в переданном memory_resource.
+class DomBuilder final : public EventHandler {
+public:
+    explicit DomBuilder(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+public:
+    void Null() override;
+    void Bool(bool value) override;
+    void Int(int value) override;
+    void Double(double value) override;
+    void String(std::string_view value) override;
+    void StartObject() override;
+    void Key(std::string_view key) override;
+    void EndObject() override;
+    void StartArray() override;
+    void EndArray() override;
+
+    Node Extract();
+
+private:
+    // Элементы открытых контейнеров копятся в общих стеках values_ и keys_,
+    // а при закрытии переносятся в контейнер точного размера
+    struct Frame {
+        size_t values_begin = 0u;
+        size_t keys_begin = 0u;
+    };
+
+    void AddValue(Node value);
+
+    std::pmr::memory_resource* resource_;
+    std::vector<Frame> stack_;
+    std::vector<Node> values_;
+    std::vector<SmallString> keys_;
+    Node root_;
+};
+
+//----------------- Writer -----------------------
+
+struct PrintSettings {
+    bool compact = false;   // Без переводов строк и отступов
+    size_t indent_step = 4;
+};
+
+// Пишет JSON-текст в собственный буфер и сбрасывает его в поток крупными блоками.
+// Числа форматируются через std::to_chars, строки экранируются участками.
+class Writer final : public EventHandler {
+public:
+    explicit Writer(std::ostream& output, PrintSettings settings = {});
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+    ~Writer();
+
+public:
+    void Null() override;
+    void Bool(bool value) override;
+    void Int(int value) override;
+    void Double(double value) override;
+    void String(std::string_view value) override;
+    void StartObject() override;
+    void Key(std::string_view key) override;
+    void EndObject() override;
+    void StartArray() override;
+    void EndArray() override;
+
+    void Flush();
+    // Сколько байт выведено с момента создания, включая ещё не сброшенные
+    size_t GetBytesWritten() const;
+
+private:
+    static constexpr size_t kFlushThreshold = 1 << 16;
+
+    void BeforeValue();
+    void BeforeItem();
+    void EndContainer(char bracket);
+    void Write(std::string_view text);
+    void WriteString(std::string_view value);
+
+private:
+    std::ostream& output_;
+    PrintSettings settings_;
+    std::string buffer_;
+    size_t flushed_ = 0u;
+    // Для каждого открытого контейнера: не было ли в нём ещё элементов
+    std::vector<bool> levels_;
+    bool after_key_ = false;
+};
+
+//----------------- Loading -----------------------
+
+// Поток читается так же, как в Parse
 Document Load(std::istream& input);
+Document Load(std::string_view input);
+// Строит дерево в арене, например в std::pmr::monotonic_buffer_resource
+Document Load(std::istream& input, std::pmr::memory_resource& arena);
+Document Load(std::string_view input, std::pmr::memory_resource& arena);
+// Отображает файл в память (где это поддерживается) и разбирает без копирования
+Document LoadFile(const std::string& path);
+
+std::string ReadAll(std::istream& input);
 
 void Print(const Document& doc, std::ostream& output);
+void Print(const Document& doc, std::ostream& output, PrintSettings settings);
+// Выводит узел как очередное значение в writer
+void Print(const Node& node, Writer& writer);
+// Передаёт handler события разбора, соответствующие дереву node
+void Emit(const Node& node, EventHandler& handler);
 
 }  // namespace json
\ No newline at end of file
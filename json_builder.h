@@ -1,109 +1,158 @@
 #pragma once
 
+#include <stdexcept>
 #include <string>
-#include <vector>
-#include <memory>
-#include <optional>
+#include <string_view>
 
 #include "json.h"
 
 namespace json {
 
-class BaseContext;
-class DictItemContext;
-class DictValueContext;
-class ArrayItemContext;
+// Вложенность строящегося документа хранится в типе контекста: контекст
+// помнит открытый контейнер и контекст родителя, в который надо вернуться.
+// Значения сразу помещаются в свой контейнер, а недопустимая
+// последовательность вызовов не компилируется.
 
-class Builder {
+class Builder;
+template <typename Parent> class DictItemContext;
+template <typename Parent> class DictValueContext;
+template <typename Parent> class ArrayItemContext;
+
+// Корневое значение задано, осталось только получить результат
+class BuildContext {
 public:
-    Builder() = default;
+    explicit BuildContext(Builder& builder);
 
 public:
-    DictItemContext StartDict();
-    BaseContext EndDict();
-    ArrayItemContext StartArray();
-    BaseContext EndArray();
-    DictValueContext Key(const std::string& key);
-    BaseContext Value(const Node::Value& val);
     Node Build();
 
 private:
-    bool IsAdd() const;
-    bool IsNullNode() const;
-    bool IsKey() const;
-    bool IsValue() const;
-    bool IsStartDict() const;
-    bool IsEndDict() const;
-    bool IsStartArray() const;
-    bool IsEndArray() const;
-    bool IsBuild() const;
-    void AddNode(Node node);
-
-private:
-    std::optional<Node> root_;
-    std::vector<std::unique_ptr<Node>> nodes_stack_;
+    Builder* builder_;
 };
 
-class BaseContext {
+class Builder {
 public:
-    BaseContext(Builder& builder);
-    DictItemContext StartDict();
-    BaseContext EndDict();
-    ArrayItemContext StartArray();
-    BaseContext EndArray();
-    DictValueContext Key(const std::string& key);
-    BaseContext Value(const Node::Value& val);
-    Node Build();
+    Builder() = default;
+
+public:
+    DictItemContext<BuildContext> StartDict();
+    ArrayItemContext<BuildContext> StartArray();
+    BuildContext Value(Node value);
 
 private:
-    Builder& builder_;
+    friend class BuildContext;
+
+    Node root_;
 };
 
-class DictItemContext : public BaseContext {
+namespace builder_detail {
+
+// Словари ответов обычно содержат несколько ключей, поэтому место
+// под них выделяется сразу, а не удвоением по одному элементу
+constexpr size_t kDictReserve = 8u;
+
+inline Dict& StartDictIn(Node& slot) {
+    slot = Dict{};
+    Dict& dict = std::get<Dict>(slot.GetValue());
+    dict.reserve(kDictReserve);
+    return dict;
+}
+
+inline Array& StartArrayIn(Node& slot) {
+    slot = Array{};
+    return std::get<Array>(slot.GetValue());
+}
+
+}  // namespace builder_detail
+
+template <typename Parent>
+class DictItemContext {
 public:
-    DictItemContext(Builder& builder);
-    DictItemContext(BaseContext context);
+    DictItemContext(Parent parent, Dict& dict)
+        : parent_(parent)
+        , dict_(&dict) {
+    }
 
 public:
-    DictValueContext Key(const std::string& key);
-    BaseContext EndDict();
-
-    DictItemContext StartDict() = delete;
-    ArrayItemContext StartArray() = delete;
-    BaseContext EndArray() = delete;
-    BaseContext Value(const Node::Value& val) = delete;
-    Node Build() = delete;
+    // Повторный ключ - ошибка, как и при разборе json::Load
+    DictValueContext<Parent> Key(std::string_view key) {
+        using namespace std::literals;
+        const auto [it, inserted] = dict_->emplace(SmallString(key), Node{});
+        if (!inserted) {
+            throw std::logic_error("Duplicate key '"s + std::string(key) + "' have been found"s);
+        }
+        return DictValueContext<Parent>(parent_, *dict_, it->second);
+    }
+
+    Parent EndDict() {
+        return parent_;
+    }
+
+private:
+    Parent parent_;
+    Dict* dict_;
 };
 
-class DictValueContext : public BaseContext {
+template <typename Parent>
+class DictValueContext {
 public:
-    DictValueContext(Builder& builder);
+    DictValueContext(Parent parent, Dict& dict, Node& slot)
+        : parent_(parent)
+        , dict_(&dict)
+        , slot_(&slot) {
+    }
 
 public:
-    DictItemContext Value(const Node::Value& val);
-    DictItemContext StartDict();
-    ArrayItemContext StartArray();
-
-    BaseContext EndDict() = delete;
-    BaseContext EndArray() = delete;
-    DictValueContext Key(const std::string& key) = delete;
-    Node Build() = delete;
+    DictItemContext<Parent> Value(Node value) {
+        *slot_ = std::move(value);
+        return DictItemContext<Parent>(parent_, *dict_);
+    }
+
+    DictItemContext<DictItemContext<Parent>> StartDict() {
+        return DictItemContext<DictItemContext<Parent>>(
+            DictItemContext<Parent>(parent_, *dict_), builder_detail::StartDictIn(*slot_));
+    }
+
+    ArrayItemContext<DictItemContext<Parent>> StartArray() {
+        return ArrayItemContext<DictItemContext<Parent>>(
+            DictItemContext<Parent>(parent_, *dict_), builder_detail::StartArrayIn(*slot_));
+    }
+
+private:
+    Parent parent_;
+    Dict* dict_;
+    Node* slot_;
 };
 
-class ArrayItemContext : public BaseContext {
+template <typename Parent>
+class ArrayItemContext {
 public:
-    ArrayItemContext(Builder& builder);
-    ArrayItemContext(BaseContext context);
+    ArrayItemContext(Parent parent, Array& array)
+        : parent_(parent)
+        , array_(&array) {
+    }
 
 public:
-    ArrayItemContext Value(const Node::Value& val);
-    DictItemContext StartDict();
-    ArrayItemContext StartArray();
-    BaseContext EndArray();
-
-    BaseContext EndDict() = delete;
-    DictValueContext Key(const std::string& key) = delete;
-    Node Build() = delete;
+    ArrayItemContext Value(Node value) {
+        array_->push_back(std::move(value));
+        return *this;
+    }
+
+    DictItemContext<ArrayItemContext> StartDict() {
+        return DictItemContext<ArrayItemContext>(*this, builder_detail::StartDictIn(array_->emplace_back()));
+    }
+
+    ArrayItemContext<ArrayItemContext> StartArray() {
+        return ArrayItemContext<ArrayItemContext>(*this, builder_detail::StartArrayIn(array_->emplace_back()));
+    }
+
+    Parent EndArray() {
+        return parent_;
+    }
+
+private:
+    Parent parent_;
+    Array* array_;
 };
 
-} // namespace json
\ No newline at end of file
+} // namespace json
@@ -0,0 +1,421 @@
+#include "json_lazy.h"
+
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+namespace json {
+using namespace std::literals;
+
+// ---------- TapeBuilder ------------------------------------------------------------
+
+// Записывает события разбора в ленту документа
+class TapeBuilder final : public EventHandler {
+public:
+    explicit TapeBuilder(LazyDocument& doc)
+        : doc_(doc) {
+    }
+
+public:
+    void Null() override {
+        AddValue({ LazyDocument::Kind::kNull });
+    }
+
+    void Bool(bool value) override {
+        AddValue({ value ? LazyDocument::Kind::kTrue : LazyDocument::Kind::kFalse });
+    }
+
+    void Int(int value) override {
+        LazyDocument::Entry entry{ LazyDocument::Kind::kInt };
+        entry.payload = static_cast<uint64_t>(static_cast<int64_t>(value));
+        AddValue(entry);
+    }
+
+    void Double(double value) override {
+        LazyDocument::Entry entry{ LazyDocument::Kind::kDouble };
+        std::memcpy(&entry.payload, &value, sizeof(value));
+        AddValue(entry);
+    }
+
+    void String(std::string_view value) override {
+        AddValue(MakeString(LazyDocument::Kind::kString, value));
+    }
+
+    void StartObject() override {
+        Start(LazyDocument::Kind::kDict);
+    }
+
+    void Key(std::string_view key) override {
+        ++doc_.tape_[stack_.back()].size;
+        doc_.tape_.push_back(MakeString(LazyDocument::Kind::kKey, key));
+    }
+
+    void EndObject() override {
+        End();
+    }
+
+    void StartArray() override {
+        Start(LazyDocument::Kind::kArray);
+    }
+
+    void EndArray() override {
+        End();
+    }
+
+private:
+    // Строки без escape-последовательностей разбор передаёт прямо из исходного текста,
+    // остальные копируются в decoded_
+    LazyDocument::Entry MakeString(LazyDocument::Kind kind, std::string_view value) {
+        LazyDocument::Entry entry{ kind };
+        entry.size = static_cast<uint32_t>(value.size());
+        const char* begin = doc_.input_.data();
+        if (value.data() >= begin && value.data() + value.size() <= begin + doc_.input_.size()) {
+            entry.payload = static_cast<uint64_t>(value.data() - begin);
+        }
+        else {
+            entry.decoded = true;
+            entry.payload = doc_.decoded_.size();
+            doc_.decoded_.append(value);
+        }
+        return entry;
+    }
+
+    void AddValue(LazyDocument::Entry entry) {
+        if (!stack_.empty() && doc_.tape_[stack_.back()].kind == LazyDocument::Kind::kArray) {
+            ++doc_.tape_[stack_.back()].size;
+        }
+        doc_.tape_.push_back(entry);
+    }
+
+    void Start(LazyDocument::Kind kind) {
+        AddValue({ kind });
+        stack_.push_back(static_cast<uint32_t>(doc_.tape_.size() - 1u));
+    }
+
+    void End() {
+        doc_.tape_[stack_.back()].payload = doc_.tape_.size();
+        stack_.pop_back();
+    }
+
+private:
+    LazyDocument& doc_;
+    std::vector<uint32_t> stack_;
+};
+
+// ---------- LazyDocument ------------------------------------------------------------
+
+LazyDocument::LazyDocument(std::string input)
+    : input_(std::move(input)) {
+    if (input_.size() > std::numeric_limits<uint32_t>::max()) {
+        throw ParsingError("Document is too large"s);
+    }
+    // Обычно токенов заметно меньше, чем байт во входе
+    tape_.reserve(input_.size() / 8u + 1u);
+    TapeBuilder builder(*this);
+    Parse(std::string_view(input_), builder);
+}
+
+LazyNode LazyDocument::GetRoot() const {
+    return LazyNode(*this, 0u);
+}
+
+uint32_t LazyDocument::Next(uint32_t index) const {
+    const Entry& entry = tape_[index];
+    if (entry.kind == Kind::kArray || entry.kind == Kind::kDict) {
+        return static_cast<uint32_t>(entry.payload);
+    }
+    return index + 1u;
+}
+
+std::string_view LazyDocument::GetString(const Entry& entry) const {
+    const std::string& storage = entry.decoded ? decoded_ : input_;
+    return std::string_view(storage).substr(static_cast<size_t>(entry.payload), entry.size);
+}
+
+// Повторяет события разбора для поддерева, начинающегося с записи index
+void LazyDocument::Replay(uint32_t index, EventHandler& handler) const {
+    const uint32_t end = Next(index);
+    std::vector<uint32_t> open;
+
+    for (uint32_t i = index; ; ++i) {
+        while (!open.empty() && tape_[open.back()].payload == i) {
+            if (tape_[open.back()].kind == Kind::kDict) {
+                handler.EndObject();
+            }
+            else {
+                handler.EndArray();
+            }
+            open.pop_back();
+        }
+        if (i == end) {
+            break;
+        }
+
+        const Entry& entry = tape_[i];
+        switch (entry.kind) {
+        case Kind::kNull:
+            handler.Null();
+            break;
+        case Kind::kFalse:
+            handler.Bool(false);
+            break;
+        case Kind::kTrue:
+            handler.Bool(true);
+            break;
+        case Kind::kInt:
+            handler.Int(static_cast<int>(static_cast<int64_t>(entry.payload)));
+            break;
+        case Kind::kDouble: {
+            double value;
+            std::memcpy(&value, &entry.payload, sizeof(value));
+            handler.Double(value);
+        } break;
+        case Kind::kString:
+            handler.String(GetString(entry));
+            break;
+        case Kind::kKey:
+            handler.Key(GetString(entry));
+            break;
+        case Kind::kArray:
+            handler.StartArray();
+            open.push_back(i);
+            break;
+        case Kind::kDict:
+            handler.StartObject();
+            open.push_back(i);
+            break;
+        }
+    }
+}
+
+LazyDocument LoadLazy(std::istream& input) {
+    return LazyDocument(ReadAll(input));
+}
+
+LazyDocument LoadLazyFile(const std::string& path) {
+    std::ifstream input(path, std::ios::binary);
+    if (!input) {
+        throw ParsingError("Failed to open "s + path);
+    }
+    return LoadLazy(input);
+}
+
+// ---------- LazyNode ------------------------------------------------------------
+
+LazyNode::LazyNode(const LazyDocument& doc, uint32_t index)
+    : doc_(&doc)
+    , index_(index) {
+}
+
+const LazyDocument::Entry& LazyNode::GetEntry() const {
+    return doc_->tape_[index_];
+}
+
+bool LazyNode::IsNull() const {
+    return GetEntry().kind == LazyDocument::Kind::kNull;
+}
+
+bool LazyNode::IsBool() const {
+    const LazyDocument::Kind kind = GetEntry().kind;
+    return kind == LazyDocument::Kind::kTrue || kind == LazyDocument::Kind::kFalse;
+}
+
+bool LazyNode::IsInt() const {
+    return GetEntry().kind == LazyDocument::Kind::kInt;
+}
+
+bool LazyNode::IsPureDouble() const {
+    return GetEntry().kind == LazyDocument::Kind::kDouble;
+}
+
+bool LazyNode::IsDouble() const {
+    return IsInt() || IsPureDouble();
+}
+
+bool LazyNode::IsString() const {
+    return GetEntry().kind == LazyDocument::Kind::kString;
+}
+
+bool LazyNode::IsArray() const {
+    return GetEntry().kind == LazyDocument::Kind::kArray;
+}
+
+bool LazyNode::IsDict() const {
+    return GetEntry().kind == LazyDocument::Kind::kDict;
+}
+
+bool LazyNode::AsBool() const {
+    if (!IsBool()) {
+        throw std::logic_error("Not a bool"s);
+    }
+    return GetEntry().kind == LazyDocument::Kind::kTrue;
+}
+
+int LazyNode::AsInt() const {
+    if (!IsInt()) {
+        throw std::logic_error("Not an int"s);
+    }
+    return static_cast<int>(static_cast<int64_t>(GetEntry().payload));
+}
+
+double LazyNode::AsDouble() const {
+    if (!IsDouble()) {
+        throw std::logic_error("Not a double"s);
+    }
+    if (IsInt()) {
+        return AsInt();
+    }
+    double value;
+    std::memcpy(&value, &GetEntry().payload, sizeof(value));
+    return value;
+}
+
+std::string_view LazyNode::AsString() const {
+    if (!IsString()) {
+        throw std::logic_error("Not a string"s);
+    }
+    return doc_->GetString(GetEntry());
+}
+
+LazyArray LazyNode::AsArray() const {
+    if (!IsArray()) {
+        throw std::logic_error("Not an array"s);
+    }
+    return LazyArray(*doc_, index_);
+}
+
+LazyDict LazyNode::AsDict() const {
+    if (!IsDict()) {
+        throw std::logic_error("Not a dict"s);
+    }
+    return LazyDict(*doc_, index_);
+}
+
+Node LazyNode::Materialize(std::pmr::memory_resource* resource) const {
+    DomBuilder builder(resource);
+    doc_->Replay(index_, builder);
+    return builder.Extract();
+}
+
+void LazyNode::Print(Writer& writer) const {
+    doc_->Replay(index_, writer);
+}
+
+void LazyNode::Emit(EventHandler& handler) const {
+    doc_->Replay(index_, handler);
+}
+
+// ---------- LazyArray ------------------------------------------------------------
+
+LazyArray::Iterator::Iterator(const LazyDocument& doc, uint32_t index)
+    : doc_(&doc)
+    , index_(index) {
+}
+
+LazyNode LazyArray::Iterator::operator*() const {
+    return LazyNode(*doc_, index_);
+}
+
+LazyArray::Iterator& LazyArray::Iterator::operator++() {
+    index_ = doc_->Next(index_);
+    return *this;
+}
+
+bool LazyArray::Iterator::operator==(const Iterator& rhs) const {
+    return index_ == rhs.index_;
+}
+
+bool LazyArray::Iterator::operator!=(const Iterator& rhs) const {
+    return !(*this == rhs);
+}
+
+LazyArray::LazyArray(const LazyDocument& doc, uint32_t index)
+    : doc_(&doc)
+    , index_(index) {
+}
+
+size_t LazyArray::size() const {
+    return doc_->tape_[index_].size;
+}
+
+bool LazyArray::empty() const {
+    return size() == 0u;
+}
+
+LazyArray::Iterator LazyArray::begin() const {
+    return Iterator(*doc_, index_ + 1u);
+}
+
+LazyArray::Iterator LazyArray::end() const {
+    return Iterator(*doc_, doc_->Next(index_));
+}
+
+// ---------- LazyDict ------------------------------------------------------------
+
+LazyDict::Iterator::Iterator(const LazyDocument& doc, uint32_t index)
+    : doc_(&doc)
+    , index_(index) {
+}
+
+LazyDict::Iterator::value_type LazyDict::Iterator::operator*() const {
+    return { doc_->GetString(doc_->tape_[index_]), LazyNode(*doc_, index_ + 1u) };
+}
+
+LazyDict::Iterator& LazyDict::Iterator::operator++() {
+    index_ = doc_->Next(index_ + 1u);
+    return *this;
+}
+
+bool LazyDict::Iterator::operator==(const Iterator& rhs) const {
+    return index_ == rhs.index_;
+}
+
+bool LazyDict::Iterator::operator!=(const Iterator& rhs) const {
+    return !(*this == rhs);
+}
+
+LazyDict::LazyDict(const LazyDocument& doc, uint32_t index)
+    : doc_(&doc)
+    , index_(index) {
+}
+
+size_t LazyDict::size() const {
+    return doc_->tape_[index_].size;
+}
+
+bool LazyDict::empty() const {
+    return size() == 0u;
+}
+
+LazyDict::Iterator LazyDict::begin() const {
+    return Iterator(*doc_, index_ + 1u);
+}
+
+LazyDict::Iterator LazyDict::end() const {
+    return Iterator(*doc_, doc_->Next(index_));
+}
+
+LazyDict::Iterator LazyDict::find(std::string_view key) const {
+    const Iterator last = end();
+    for (Iterator it = begin(); it != last; ++it) {
+        if ((*it).first == key) {
+            return it;
+        }
+    }
+    return last;
+}
+
+size_t LazyDict::count(std::string_view key) const {
+    return find(key) != end() ? 1u : 0u;
+}
+
+LazyNode LazyDict::at(std::string_view key) const {
+    const Iterator it = find(key);
+    if (it == end()) {
+        throw std::out_of_range("Key '"s + std::string(key) + "' is not found"s);
+    }
+    return (*it).second;
+}
+
+}  // namespace json
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "json.h"
+
+namespace json {
+
+class LazyNode;
+class LazyArray;
+class LazyDict;
+
+// Документ, разобранный в плоскую ленту (tape) за один проход.
+// Каждый токен - одна запись: строки хранятся смещением в исходном тексте,
+// контейнеры - числом элементов и индексом записи за своим концом, поэтому
+// ненужное поддерево пропускается одним переходом. Узлы Node не создаются:
+// LazyNode только указывает на запись ленты, а Materialize строит обычное
+// дерево для выбранного поддерева, если оно действительно нужно.
+class LazyDocument {
+public:
+    // Бросает ParsingError при ошибке разбора
+    explicit LazyDocument(std::string input);
+
+public:
+    LazyNode GetRoot() const;
+
+private:
+    friend class LazyNode;
+    friend class LazyArray;
+    friend class LazyDict;
+    friend class TapeBuilder;
+
+    enum class Kind : uint8_t {
+        kNull,
+        kFalse,
+        kTrue,
+        kInt,
+        kDouble,
+        kString,
+        kKey,
+        kArray,
+        kDict
+    };
+
+    struct Entry {
+        Kind kind = Kind::kNull;
+        bool decoded = false;   // Строка с escape-последовательностями лежит в decoded_
+        uint32_t size = 0u;     // Длина строки или число элементов контейнера
+        uint64_t payload = 0u;  // Смещение строки, значение числа или индекс за концом контейнера
+    };
+
+    uint32_t Next(uint32_t index) const;
+    std::string_view GetString(const Entry& entry) const;
+    void Replay(uint32_t index, EventHandler& handler) const;
+
+private:
+    std::string input_;
+    std::string decoded_;
+    std::vector<Entry> tape_;
+};
+
+// Читают вход целиком: лента ссылается на исходный текст
+LazyDocument LoadLazy(std::istream& input);
+LazyDocument LoadLazyFile(const std::string& path);
+
+// Ссылка на значение в LazyDocument. Действительна, пока жив документ.
+class LazyNode {
+public:
+    LazyNode(const LazyDocument& doc, uint32_t index);
+
+public:
+    bool IsNull() const;
+    bool IsBool() const;
+    bool IsInt() const;
+    bool IsPureDouble() const;
+    bool IsDouble() const;
+    bool IsString() const;
+    bool IsArray() const;
+    bool IsDict() const;
+
+    bool AsBool() const;
+    int AsInt() const;
+    double AsDouble() const;
+    std::string_view AsString() const;
+    LazyArray AsArray() const;
+    LazyDict AsDict() const;
+
+    // Строит обычное дерево Node для этого поддерева
+    Node Materialize(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const;
+    // Выводит поддерево как очередное значение writer, не создавая Node
+    void Print(Writer& writer) const;
+    // Передаёт handler события разбора поддерева, как json::Emit для Node
+    void Emit(EventHandler& handler) const;
+
+private:
+    const LazyDocument::Entry& GetEntry() const;
+
+    const LazyDocument* doc_;
+    uint32_t index_;
+};
+
+class LazyArray {
+public:
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = LazyNode;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = LazyNode;
+
+        Iterator(const LazyDocument& doc, uint32_t index);
+
+        LazyNode operator*() const;
+        Iterator& operator++();
+        bool operator==(const Iterator& rhs) const;
+        bool operator!=(const Iterator& rhs) const;
+
+    private:
+        const LazyDocument* doc_;
+        uint32_t index_;
+    };
+
+    LazyArray(const LazyDocument& doc, uint32_t index);
+
+public:
+    size_t size() const;
+    bool empty() const;
+    Iterator begin() const;
+    Iterator end() const;
+
+private:
+    const LazyDocument* doc_;
+    uint32_t index_;
+};
+
+// Ключи ищутся линейным просмотром ленты с пропуском значений
+class LazyDict {
+public:
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::pair<std::string_view, LazyNode>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = value_type;
+
+        Iterator(const LazyDocument& doc, uint32_t index);
+
+        value_type operator*() const;
+        Iterator& operator++();
+        bool operator==(const Iterator& rhs) const;
+        bool operator!=(const Iterator& rhs) const;
+
+    private:
+        const LazyDocument* doc_;
+        uint32_t index_;
+    };
+
+    LazyDict(const LazyDocument& doc, uint32_t index);
+
+public:
+    size_t size() const;
+    bool empty() const;
+    Iterator begin() const;
+    Iterator end() const;
+
+    Iterator find(std::string_view key) const;
+    size_t count(std::string_view key) const;
+    // Бросает std::out_of_range, если ключа нет
+    LazyNode at(std::string_view key) const;
+
+private:
+    const LazyDocument* doc_;
+    uint32_t index_;
+};
+
+}  // namespace json
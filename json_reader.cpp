@@ -1,24 +1,79 @@
 #include "json_reader.h"
+#include "metrics.h"
+#include "pipeline.h"
 
 namespace json_reader {
 using namespace std::literals;
 
+namespace {
+
+// Ответ на строку JSON Lines: результат запроса или текст ошибки
+// с номером запроса, если он известен
+struct LineAnswer {
+    std::optional<reader::StatInfo> stat;
+    std::optional<int> id;
+    std::string error;
+};
+
+bool IsBlank(std::string_view line) {
+    return line.find_first_not_of(" \t\r"sv) == std::string_view::npos;
+}
+
+RequestsDecoder Decode(const json::Node& root) {
+    RequestsDecoder decoder;
+    json::Emit(root, decoder);
+    return decoder;
+}
+
+RequestsDecoder Decode(std::istream& input, std::pmr::memory_resource& arena) {
+    RequestsDecoder decoder(&arena);
+    json::Parse(input, decoder);
+    return decoder;
+}
+
+RequestsDecoder Decode(const json::LazyDocument& doc) {
+    RequestsDecoder decoder;
+    doc.GetRoot().Emit(decoder);
+    return decoder;
+}
+
+}  // namespace
+
 JSONReader::JSONReader(json::Document doc)
-    : requests_(doc) {
+    : JSONReader(Decode(doc.GetRoot()), nullptr) {
 }
 
-void JSONReader::LoadDataToTC(tc::TransportCatalogue& catalog) const {
-    json::Array base_requests = requests_.GetRoot().AsDict().at("base_requests"s).AsArray();
+JSONReader::JSONReader(std::istream& input, std::pmr::memory_resource& arena)
+    : JSONReader(Decode(input, arena), &arena) {
+}
 
-    auto it = std::partition(
-        base_requests.begin(), base_requests.end(), [](const json::Node& node) {
-            return node.AsDict().at("type"s).AsString() == "Stop"s;
-        });
+JSONReader::JSONReader(const json::LazyDocument& doc)
+    : JSONReader(Decode(doc), nullptr) {
+}
 
-    LoadStopsToTC(catalog, base_requests.begin(), it);
+JSONReader::JSONReader(RequestsDecoder decoder, std::pmr::memory_resource* arena)
+    : requests_(arena ? json::Document(decoder.ExtractSettings(), *arena)
+                      : json::Document(decoder.ExtractSettings()))
+    , base_(std::move(decoder.GetBaseRequests()))
+    , stat_commands_(std::move(decoder.GetStatCommands())) {
+}
 
-    for (auto i = it; i != base_requests.end(); ++i) {
-        LoadBusToTC(catalog, *i);
+void JSONReader::LoadDataToTC(tc::TransportCatalogue& catalog) const {
+    // Расстояния ссылаются на остановки, которые могут быть описаны позже
+    std::vector<tc::StopPtr> stops;
+    stops.reserve(base_.stops.size());
+    for (const StopRequest& request : base_.stops) {
+        stops.push_back(catalog.AddStop(request.stop));
+    }
+
+    for (size_t i = 0u; i < stops.size(); ++i) {
+        for (const DistanceSpec& distance : base_.stops[i].distances) {
+            catalog.AddStopsDistance(stops[i], { distance.dest, distance.distance_meters });
+        }
+    }
+
+    for (const BusRequest& request : base_.buses) {
+        LoadBusToTC(catalog, request);
     }
 }
 
@@ -26,140 +81,234 @@ map_render::RenderSettings JSONReader::GetRenderSettings() const {
     using namespace std::literals;
 
     map_render::RenderSettings settings;
-    const json::Dict& map_render = requests_.GetRoot().AsDict().at("render_settings"s).AsDict();
-
-    settings.width = map_render.at("width"s).AsDouble();
-    settings.height = map_render.at("height"s).AsDouble();
-    settings.padding = map_render.at("padding"s).AsDouble();
-    settings.line_width = map_render.at("line_width"s).AsDouble();
-    settings.stop_radius = map_render.at("stop_radius"s).AsDouble();
-    settings.bus_label_font_size = map_render.at("bus_label_font_size"s).AsInt();
-    settings.bus_label_offset.first = map_render.at("bus_label_offset"s).AsArray()[0].AsDouble();
-    settings.bus_label_offset.second = map_render.at("bus_label_offset"s).AsArray()[1].AsDouble();
-    settings.stop_label_font_size = map_render.at("stop_label_font_size"s).AsInt();
-    settings.stop_label_offset.first = map_render.at("stop_label_offset"s).AsArray()[0].AsDouble();
-    settings.stop_label_offset.second = map_render.at("stop_label_offset"s).AsArray()[1].AsDouble();
-    settings.underlayer_color = ParseColor(map_render.at("underlayer_color"s));
-    settings.underlayer_width = map_render.at("underlayer_width"s).AsDouble();
-
-    for (const auto& node : map_render.at("color_palette"s).AsArray()) {
+    const json::Dict& map_render = requests_.GetRoot().AsDict().at("render_settings"sv).AsDict();
+
+    settings.width = map_render.at("width"sv).AsDouble();
+    settings.height = map_render.at("height"sv).AsDouble();
+    settings.padding = map_render.at("padding"sv).AsDouble();
+    settings.line_width = map_render.at("line_width"sv).AsDouble();
+    settings.stop_radius = map_render.at("stop_radius"sv).AsDouble();
+    settings.bus_label_font_size = map_render.at("bus_label_font_size"sv).AsInt();
+    settings.bus_label_offset.first = map_render.at("bus_label_offset"sv).AsArray()[0].AsDouble();
+    settings.bus_label_offset.second = map_render.at("bus_label_offset"sv).AsArray()[1].AsDouble();
+    settings.stop_label_font_size = map_render.at("stop_label_font_size"sv).AsInt();
+    settings.stop_label_offset.first = map_render.at("stop_label_offset"sv).AsArray()[0].AsDouble();
+    settings.stop_label_offset.second = map_render.at("stop_label_offset"sv).AsArray()[1].AsDouble();
+    settings.underlayer_color = ParseColor(map_render.at("underlayer_color"sv));
+    settings.underlayer_width = map_render.at("underlayer_width"sv).AsDouble();
+
+    for (const auto& node : map_render.at("color_palette"sv).AsArray()) {
         settings.color_palette.push_back(ParseColor(node));
     }
 
+    if (map_render.count("coordinate_decimals"sv)) {
+        settings.coordinate_decimals = map_render.at("coordinate_decimals"sv).AsInt();
+    }
+
     return settings;
 }
 
-void JSONReader::PrintStats(std::ostream& output, const std::vector<reader::StatInfo>& stats_info) {
-    json::Array result;
-
+void JSONReader::PrintStats(std::ostream& output, const std::vector<reader::StatInfo>& stats_info,
+    json::PrintSettings settings) {
+    json::Writer writer(output, settings);
+    writer.StartArray();
     for (const auto& stat : stats_info) {
-        switch (stat.query_type)
-        {
-        case reader::QueryType::kMap:
-            result.push_back(std::move(ParseMapStat(stat)));
-            break;
-        case reader::QueryType::kStop:
-            result.push_back(std::move(ParseStopStat(stat)));
-            break;
-        case reader::QueryType::kBus:
-            result.push_back(std::move(ParseBusStat(stat)));
-            break;
-        case reader::QueryType::kRoute:
-            result.push_back(std::move(ParseRouteStat(stat)));
-            break;
-        default:
-            break;
-        }
-    }
-    json::Print(json::Document(std::move(result)), output);
-}
-
-std::vector<reader::StatCommand> JSONReader::GetStatCommands() const {
-    std::vector<reader::StatCommand> result;
-    const json::Node& stat_requests = requests_.GetRoot().AsDict().at("stat_requests"s);
-
-    for (const auto& node : stat_requests.AsArray()) {
-        reader::StatCommand command;
-        command.query_type = DefineRequestType(node.AsDict().at("type"s).AsString());
-        command.id = node.AsDict().at("id"s).AsInt();
-        if (command.query_type == reader::QueryType::kRoute) {
-            command.data = reader::RouteCommand{
-                node.AsDict().at("from"s).AsString(), node.AsDict().at("to"s).AsString()
-            };
-        } else
-        if (command.query_type != reader::QueryType::kMap)
-            command.data = node.AsDict().at("name"s).AsString();
-        
-        result.push_back(command);
+        PrintStat(stat, writer);
     }
+    writer.EndArray();
+}
 
-    return result;
+void JSONReader::PrintStats(std::ostream& output, const handler::RequestHandler& handler,
+    const std::vector<reader::StatCommand>& commands, json::PrintSettings settings) const {
+    json::Writer writer(output, settings);
+    writer.StartArray();
+    handler.ProcessStats(commands, [this, &writer](const reader::StatInfo& stat) {
+        PrintStat(stat, writer);
+        });
+    writer.EndArray();
 }
 
-domain::RouteSettings JSONReader::GetRouteSettings() const {
-    domain::RouteSettings result;
+void JSONReader::PrintStatsPipelined(std::ostream& output, const handler::RequestHandler& handler,
+    const std::vector<reader::StatCommand>& commands, json::PrintSettings settings,
+    size_t executors_count) const {
+    json::Writer writer(output, settings);
+    writer.StartArray();
+    handler.PipelineStats(commands, [this, &writer](const reader::StatInfo& stat) {
+        PrintStat(stat, writer);
+        }, executors_count);
+    writer.EndArray();
+}
 
-    const json::Dict& stat_requests = requests_.GetRoot().AsDict().at("routing_settings"s).AsDict();
-    result.bus_wait_time = stat_requests.at("bus_wait_time"s).AsDouble();
-    result.bus_velocity = stat_requests.at("bus_velocity"s).AsDouble();
+const std::vector<reader::StatCommand>& JSONReader::GetStatCommands() const {
+    return stat_commands_;
+}
 
-    return result;
+void JSONReader::ServeJsonLines(std::istream& input, std::ostream& output,
+    const handler::RequestHandler& handler) const {
+    json::PrintSettings settings;
+    settings.compact = true;
+    json::Writer writer(output, settings);
+    std::string line;
+
+    while (std::getline(input, line)) {
+        if (IsBlank(line)) {
+            continue;
+        }
+
+        AnswerLine(line, handler, writer);
+        writer.Flush();
+        output.put('\n');
+        output.flush();
+    }
 }
 
-void JSONReader::LoadStopsToTC(tc::TransportCatalogue& catalog,
-    std::vector<json::Node>::const_iterator first, std::vector<json::Node>::const_iterator last) const {
-    std::vector <std::pair<tc::StopPtr, std::vector<DistanceSpec>>> stops;
-    stops.reserve(std::distance(first, last));
+void JSONReader::ServeJsonLinesPipelined(std::istream& input, std::ostream& output,
+    const handler::RequestHandler& handler, size_t executors_count) const {
+    json::PrintSettings settings;
+    settings.compact = true;
+    json::Writer writer(output, settings);
+
+    // Строки читаются на другом потоке: связанный поток вывода (std::cin с std::cout)
+    // сбрасывался бы оттуда одновременно с записью ответов
+    std::ostream* const tied = input.tie(nullptr);
+
+    pipeline::Pipeline<std::string, LineAnswer>(executors_count).Run(
+        [&input](std::string& line) {
+            while (std::getline(input, line)) {
+                if (!IsBlank(line)) {
+                    return true;
+                }
+            }
+            return false;
+        },
+        [&handler](std::string&& line) {
+            LineAnswer answer;
+            reader::StatCommand command;
+            try {
+                command = RequestsDecoder::DecodeStatCommand(line);
+            }
+            catch (const StatCommandError& e) {
+                answer.id = e.GetId();
+                answer.error = e.what();
+                return answer;
+            }
+
+            answer.id = command.id;
+            try {
+                answer.stat = handler.GetStat(command);
+            }
+            catch (const std::out_of_range&) {
+                answer.error = "not found"s;
+            }
+            catch (const std::exception& e) {
+                answer.error = e.what();
+            }
+            return answer;
+        },
+        [this, &writer, &output](LineAnswer& answer) {
+            if (answer.stat) {
+                PrintStat(*answer.stat, writer);
+            }
+            else {
+                PrintError(answer.id, answer.error, writer);
+            }
+            writer.Flush();
+            output.put('\n');
+            output.flush();
+        },
+        // При ошибке вывода не ждём следующей строки ввода
+        pipeline::SourceOnError::kDetach);
+
+    input.tie(tied);
+}
 
-    for (auto it = first; it != last; ++it) {
-        stops.push_back(
-            { catalog.AddStop(std::move(ParseStopCommand(*it))), ParseDistances(*it) }
-        );
+void JSONReader::AnswerLine(std::string_view line, const handler::RequestHandler& handler,
+    json::Writer& writer) const {
+    // Ошибка в одной строке не должна останавливать обработку остальных
+    reader::StatCommand command;
+    try {
+        command = RequestsDecoder::DecodeStatCommand(line);
+    }
+    catch (const StatCommandError& e) {
+        PrintError(e.GetId(), e.what(), writer);
+        return;
     }
+    AnswerCommand(command, handler, writer);
+}
 
-    for (const auto& stop : stops) {
-        for (size_t i = 0u; i < stop.second.size(); ++i) {
-            catalog.AddStopsDistance(stop.first, { stop.second[i].dest, stop.second[i].distance_meters });
-        }
+void JSONReader::AnswerCommand(const reader::StatCommand& command, const handler::RequestHandler& handler,
+    json::Writer& writer) const {
+    try {
+        PrintStat(handler.GetStat(command), writer);
+    }
+    catch (const std::out_of_range&) {
+        // Поиск по неизвестному имени
+        PrintError(command.id, "not found"sv, writer);
     }
+    catch (const std::exception& e) {
+        PrintError(command.id, e.what(), writer);
+    }
+}
+
+void JSONReader::AnswerError(std::optional<int> id, std::string_view message, json::Writer& writer) const {
+    PrintError(id, message, writer);
 }
 
-domain::Stop JSONReader::ParseStopCommand(const json::Node& node) const {
-    tc::Stop result;
-    const json::Dict& dict = node.AsDict();
+domain::RouteSettings JSONReader::GetRouteSettings() const {
+    domain::RouteSettings result;
 
-    result.name = dict.at("name"s).AsString();
-    result.position.lat = dict.at("latitude"s).AsDouble();
-    result.position.lng = dict.at("longitude"s).AsDouble();
+    const json::Dict& stat_requests = requests_.GetRoot().AsDict().at("routing_settings"sv).AsDict();
+    result.bus_wait_time = stat_requests.at("bus_wait_time"sv).AsDouble();
+    result.bus_velocity = stat_requests.at("bus_velocity"sv).AsDouble();
 
     return result;
 }
 
-std::vector<DistanceSpec> JSONReader::ParseDistances(const json::Node node) const {
-    std::vector <DistanceSpec> distances;
-    const json::Dict& dict = node.AsDict();
+geo::DistanceMode JSONReader::GetDistanceMode() const {
+    const json::Dict& root = requests_.GetRoot().AsDict();
+    if (!root.count("distance_settings"sv)) {
+        return geo::DistanceMode::kExact;
+    }
+
+    const json::Dict& settings = root.at("distance_settings"sv).AsDict();
+    if (!settings.count("mode"sv)) {
+        return geo::DistanceMode::kExact;
+    }
+
+    const std::string_view mode = settings.at("mode"sv).AsString();
+    if (mode == "exact"sv) {
+        return geo::DistanceMode::kExact;
+    }
+    if (mode == "equirectangular"sv) {
+        return geo::DistanceMode::kEquirectangular;
+    }
+    throw std::invalid_argument("Unknown distance mode '"s + std::string(mode) + "'"s);
+}
 
-    if (dict.count("road_distances"s)) {
-        for (const auto& [key, value] : dict.at("road_distances"s).AsDict()) {
-            distances.push_back({ value.AsInt(), key });
+json::PrintSettings JSONReader::GetPrintSettings() const {
+    json::PrintSettings result;
+    const json::Dict& root = requests_.GetRoot().AsDict();
+    if (root.count("output_settings"sv)) {
+        const json::Dict& settings = root.at("output_settings"sv).AsDict();
+        if (settings.count("compact"sv)) {
+            result.compact = settings.at("compact"sv).AsBool();
         }
     }
 
-    return distances;
+    return result;
 }
 
-void JSONReader::LoadBusToTC(tc::TransportCatalogue& catalog, const json::Node& node) const {
+void JSONReader::LoadBusToTC(tc::TransportCatalogue& catalog, const BusRequest& request) const {
     std::vector<tc::StopPtr> stops_in_tc;
     tc::Bus bus;
-    const json::Dict& dict = node.AsDict();
 
-    bus.name = dict.at("name"s).AsString();
-    bus.is_roundtrip = dict.at("is_roundtrip"s).AsBool();
+    bus.name = request.name;
+    bus.is_roundtrip = request.is_roundtrip;
 
-    stops_in_tc.reserve(dict.at("stops"s).AsArray().size());
+    stops_in_tc.reserve(request.stops.size());
 
-    for (const auto& stop : dict.at("stops"s).AsArray()) {
-        stops_in_tc.push_back(catalog.GetStopByName(stop.AsString()));
+    for (const std::string& stop : request.stops) {
+        stops_in_tc.push_back(catalog.GetStopByName(stop));
     }
 
     bus.stops = stops_in_tc;
@@ -191,99 +340,143 @@ svg::Color JSONReader::ParseColor(const json::Node& node) const {
         }
     }
 
-    return node.AsString();
+    return std::string(node.AsString());
 }
 
-json::Node JSONReader::ParseMapStat(const reader::StatInfo& stat_info) const {
-    return
-        json::Builder{}
-            .StartDict()
-                .Key("request_id"s).Value(stat_info.id)
-                .Key("map"s).Value(std::get<std::string>(stat_info.info))
-            .EndDict()
-        .Build();
+void JSONReader::PrintStat(const reader::StatInfo& stat_info, json::Writer& writer) const {
+    const size_t written = writer.GetBytesWritten();
+    switch (stat_info.query_type) {
+    case reader::QueryType::kMap:
+        PrintMapStat(stat_info, writer);
+        break;
+    case reader::QueryType::kStop:
+        PrintStopStat(stat_info, writer);
+        break;
+    case reader::QueryType::kBus:
+        PrintBusStat(stat_info, writer);
+        break;
+    case reader::QueryType::kRoute:
+        PrintRouteStat(stat_info, writer);
+        break;
+    case reader::QueryType::kMetrics:
+        PrintMetricsStat(stat_info, writer);
+        break;
+    }
+    metrics::Add(metrics::Counter::kBytesEmitted, writer.GetBytesWritten() - written);
 }
 
-json::Node JSONReader::ParseBusStat(const reader::StatInfo& stat_info) const {
+void JSONReader::PrintMapStat(const reader::StatInfo& stat_info, json::Writer& writer) const {
+    json::StreamWriter(writer).StartDict()
+            .Key("request_id"sv).Value(stat_info.id)
+            .Key("map"sv).Value(*std::get<std::shared_ptr<const std::string>>(stat_info.info))
+        .EndDict();
+}
+
+void JSONReader::PrintBusStat(const reader::StatInfo& stat_info, json::Writer& writer) const {
     if (const domain::BusStat* value = std::get_if<domain::BusStat>(&stat_info.info)) {
-    return json::Builder{}.StartDict()
-            .Key("request_id"s).Value(stat_info.id)
-            .Key("curvature"s).Value(value->curvature)
-            .Key("unique_stop_count"s).Value(static_cast<int>(value->unique_stops))
-            .Key("stop_count"s).Value(static_cast<int>(value->stops_count))
-            .Key("route_length"s).Value(value->route_length)
-        .EndDict().Build();
+        json::StreamWriter(writer).StartDict()
+                .Key("request_id"sv).Value(stat_info.id)
+                .Key("curvature"sv).Value(value->curvature)
+                .Key("unique_stop_count"sv).Value(static_cast<int>(value->unique_stops))
+                .Key("stop_count"sv).Value(static_cast<int>(value->stops_count))
+                .Key("route_length"sv).Value(value->route_length)
+            .EndDict();
+        return;
     }
 
-    return json::Builder{}.StartDict()
-            .Key("request_id"s).Value(stat_info.id)
-            .Key("error_message"s).Value("not found"s)
-        .EndDict().Build();
+    PrintNotFound(stat_info, writer);
 }
 
-json::Node JSONReader::ParseStopStat(const reader::StatInfo& stat_info) const {
+void JSONReader::PrintStopStat(const reader::StatInfo& stat_info, json::Writer& writer) const {
     auto& info = std::get<domain::StopStat>(stat_info.info);
     if (info.is_found) {
-        json::Array buses;
+        auto buses = json::StreamWriter(writer).StartDict()
+                .Key("request_id"sv).Value(stat_info.id)
+                .Key("buses"sv).StartArray();
         for (std::string_view bus : info.data) {
-            buses.push_back(json::Node(static_cast<std::string>(bus)));
+            buses.Value(bus);
         }
-        return json::Builder{}.StartDict()
-                .Key("request_id"s).Value(stat_info.id)
-                .Key("buses"s).Value(buses)
-            .EndDict().Build();
+        buses.EndArray().EndDict();
+        return;
     }
 
-    return json::Builder{}.StartDict()
-            .Key("request_id"s).Value(stat_info.id)
-            .Key("error_message"s).Value("not found"s)
-        .EndDict().Build();
+    PrintNotFound(stat_info, writer);
 }
 
-json::Node JSONReader::ParseRouteStat(const reader::StatInfo& stat_info) const {
+void JSONReader::PrintRouteStat(const reader::StatInfo& stat_info, json::Writer& writer) const {
     if (const domain::TRouteStat* value = std::get_if<domain::TRouteStat>(&stat_info.info)) {
-        json::Array items;
+        auto items = json::StreamWriter(writer).StartDict()
+                .Key("request_id"sv).Value(stat_info.id)
+                .Key("total_time"sv).Value(value->total_time)
+                .Key("items"sv).StartArray();
 
         for (const auto& item : value->items) {
             if (item.type == domain::TRouteType::kWait) {
-                items.push_back(
-                    json::Builder{}.StartDict()
-                    .Key("type"s).Value("Wait"s)
-                    .Key("stop_name"s).Value(static_cast<std::string>(item.name))
-                    .Key("time"s).Value(item.time)
-                    .EndDict().Build()
-                );
+                items.StartDict()
+                        .Key("type"sv).Value("Wait"sv)
+                        .Key("stop_name"sv).Value(item.name)
+                        .Key("time"sv).Value(item.time)
+                    .EndDict();
             }
             else {
-                items.push_back(
-                    json::Builder{}.StartDict()
-                    .Key("type"s).Value("Bus"s)
-                    .Key("bus"s).Value(static_cast<std::string>(item.name))
-                    .Key("time"s).Value(item.time)
-                    .Key("span_count"s).Value(item.span_cout)
-                    .EndDict().Build()
-                );
+                items.StartDict()
+                        .Key("type"sv).Value("Bus"sv)
+                        .Key("bus"sv).Value(item.name)
+                        .Key("time"sv).Value(item.time)
+                        .Key("span_count"sv).Value(item.span_cout)
+                    .EndDict();
             }
         }
 
-        return json::Builder{}.StartDict()
-            .Key("request_id"s).Value(stat_info.id)
-            .Key("total_time"s).Value(value->total_time)
-            .Key("items"s).Value(items)
-            .EndDict().Build();
+        items.EndArray().EndDict();
+        return;
     }
 
-    return json::Builder{}.StartDict()
-        .Key("request_id"s).Value(stat_info.id)
-        .Key("error_message"s).Value("not found"s)
-        .EndDict().Build();
+    PrintNotFound(stat_info, writer);
 }
 
-reader::QueryType JSONReader::DefineRequestType(std::string_view query) const {
-    if (query == "Bus"s) return reader::QueryType::kBus;
-    if (query == "Map"s) return reader::QueryType::kMap;
-    if (query == "Route"s) return reader::QueryType::kRoute;
-    return reader::QueryType::kStop;
+void JSONReader::PrintMetricsStat(const reader::StatInfo& stat_info, json::Writer& writer) const {
+    const auto& info = std::get<domain::MetricsStat>(stat_info.info);
+    // Значения могут не поместиться в int, поэтому выводятся как double
+    auto counters = json::StreamWriter(writer).StartDict()
+            .Key("request_id"sv).Value(stat_info.id)
+            .Key("enabled"sv).Value(info.enabled)
+            .Key("counters"sv).StartDict();
+    for (const auto& [name, value] : info.counters) {
+        counters.Key(name).Value(static_cast<double>(value));
+    }
+
+    auto latency = counters.EndDict()
+            .Key("latency_ns"sv).StartDict();
+    for (const domain::HistogramStat& stat : info.histograms) {
+        latency.Key(stat.name).StartDict()
+                .Key("count"sv).Value(static_cast<double>(stat.count))
+                .Key("mean"sv).Value(stat.count ? static_cast<double>(stat.total / stat.count) : 0.0)
+                .Key("p50"sv).Value(static_cast<double>(stat.p50))
+                .Key("p90"sv).Value(static_cast<double>(stat.p90))
+                .Key("p99"sv).Value(static_cast<double>(stat.p99))
+                .Key("max"sv).Value(static_cast<double>(stat.max))
+            .EndDict();
+    }
+    latency.EndDict().EndDict();
+}
+
+void JSONReader::PrintNotFound(const reader::StatInfo& stat_info, json::Writer& writer) const {
+    json::StreamWriter(writer).StartDict()
+            .Key("request_id"sv).Value(stat_info.id)
+            .Key("error_message"sv).Value("not found"sv)
+        .EndDict();
+}
+
+void JSONReader::PrintError(std::optional<int> id, std::string_view message, json::Writer& writer) const {
+    const size_t written = writer.GetBytesWritten();
+    auto dict = json::StreamWriter(writer).StartDict();
+    if (id) {
+        dict.Key("request_id"sv).Value(*id);
+    }
+    dict.Key("error_message"sv).Value(message)
+        .EndDict();
+    metrics::Add(metrics::Counter::kBytesEmitted, writer.GetBytesWritten() - written);
 }
 
 }
\ No newline at end of file
@@ -1,43 +1,80 @@
 #pragma once
 
 #include "request_handler.h"
-#include "json_builder.h"
+#include "json_lazy.h"
+#include "json_stream.h"
 #include "map_renderer.h"
+#include "requests_decoder.h"
 
 namespace json_reader {
 using namespace std::literals;
 
-struct DistanceSpec {
-    int distance_meters;
-    std::string dest;
-};
-
 class JSONReader {
 public:
     JSONReader(json::Document doc);
+    // Разбирает документ запросов из потока без построения общего дерева.
+    // Настройки размещаются в arena, которая должна пережить JSONReader.
+    JSONReader(std::istream& input, std::pmr::memory_resource& arena);
+    // Разбирает документ, уже загруженный в ленту. Документ может быть удалён
+    // после конструктора: строки и настройки копируются.
+    JSONReader(const json::LazyDocument& doc);
 
 public:
     void LoadDataToTC(tc::TransportCatalogue& catalog) const;
     map_render::RenderSettings GetRenderSettings() const;
-    void PrintStats(std::ostream& output, const std::vector<reader::StatInfo>& stats_info);
-    std::vector<reader::StatCommand> GetStatCommands() const;
+    void PrintStats(std::ostream& output, const std::vector<reader::StatInfo>& stats_info,
+        json::PrintSettings settings = {});
+    // Выводит каждый ответ сразу после выполнения запроса, не собирая общий массив
+    void PrintStats(std::ostream& output, const handler::RequestHandler& handler,
+        const std::vector<reader::StatCommand>& commands, json::PrintSettings settings = {}) const;
+    // То же, но запросы выполняются конвейером на executors_count потоках (0 - по числу ядер)
+    void PrintStatsPipelined(std::ostream& output, const handler::RequestHandler& handler,
+        const std::vector<reader::StatCommand>& commands, json::PrintSettings settings,
+        size_t executors_count) const;
+    const std::vector<reader::StatCommand>& GetStatCommands() const;
+    // Режим JSON Lines: каждая строка input содержит один stat-запрос, ответ на него
+    // выводится одной строкой и сразу сбрасывается в output
+    void ServeJsonLines(std::istream& input, std::ostream& output,
+        const handler::RequestHandler& handler) const;
+    // Режим JSON Lines конвейером: чтение строк, их разбор с выполнением на executors_count
+    // потоках и вывод ответов в порядке строк идут одновременно. При ошибке вывода
+    // чтение input может продолжаться в отсоединённом потоке, поэтому input должен
+    // жить до конца программы (например, std::cin).
+    void ServeJsonLinesPipelined(std::istream& input, std::ostream& output,
+        const handler::RequestHandler& handler, size_t executors_count) const;
+    // Выполняет запрос из одной строки JSON и пишет ответ в writer.
+    // Ошибки разбора и выполнения выводятся как ответ с error_message.
+    void AnswerLine(std::string_view line, const handler::RequestHandler& handler,
+        json::Writer& writer) const;
+    // То же для уже разобранного запроса
+    void AnswerCommand(const reader::StatCommand& command, const handler::RequestHandler& handler,
+        json::Writer& writer) const;
+    // Пишет ответ с error_message, например об ошибке разбора строки.
+    // request_id выводится, если номер запроса известен.
+    void AnswerError(std::optional<int> id, std::string_view message, json::Writer& writer) const;
     domain::RouteSettings GetRouteSettings() const;
+    geo::DistanceMode GetDistanceMode() const;
+    json::PrintSettings GetPrintSettings() const;
 
 private:
-    void LoadStopsToTC(tc::TransportCatalogue& catalog,
-        std::vector<json::Node>::const_iterator first, std::vector<json::Node>::const_iterator last) const;
-    domain::Stop ParseStopCommand(const json::Node& node) const;
-    std::vector<DistanceSpec> ParseDistances(const json::Node node) const;
-    void LoadBusToTC(tc::TransportCatalogue& catalog, const json::Node& node) const;
+    JSONReader(RequestsDecoder decoder, std::pmr::memory_resource* arena);
+
+    void LoadBusToTC(tc::TransportCatalogue& catalog, const BusRequest& request) const;
     svg::Color ParseColor(const json::Node& node) const;
-    json::Node ParseMapStat(const reader::StatInfo& stat_info) const;
-    json::Node ParseBusStat(const reader::StatInfo& stat_info) const;
-    json::Node ParseStopStat(const reader::StatInfo& stat_info) const;
-    json::Node ParseRouteStat(const reader::StatInfo& stat_info) const;
-    reader::QueryType DefineRequestType(std::string_view query) const;
+    void PrintStat(const reader::StatInfo& stat_info, json::Writer& writer) const;
+    void PrintMapStat(const reader::StatInfo& stat_info, json::Writer& writer) const;
+    void PrintBusStat(const reader::StatInfo& stat_info, json::Writer& writer) const;
+    void PrintStopStat(const reader::StatInfo& stat_info, json::Writer& writer) const;
+    void PrintRouteStat(const reader::StatInfo& stat_info, json::Writer& writer) const;
+    void PrintMetricsStat(const reader::StatInfo& stat_info, json::Writer& writer) const;
+    void PrintNotFound(const reader::StatInfo& stat_info, json::Writer& writer) const;
+    void PrintError(std::optional<int> id, std::string_view message, json::Writer& writer) const;
 
 private:
+    // Корень документа без base_requests и stat_requests
     json::Document requests_;
+    BaseRequests base_;
+    std::vector<reader::StatCommand> stat_commands_;
 };
 
 }
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include "json.h"
+
+namespace json {
+
+// Типизированная запись JSON прямо в Writer, без построения дерева Node.
+// Каждый вызов возвращает контекст, в котором допустимы только корректные
+// продолжения, поэтому неверный порядок вызовов не компилируется:
+//
+//     StreamWriter(writer).StartDict()
+//         .Key("request_id"sv).Value(id)
+//         .Key("buses"sv).StartArray()
+//             .Value("14"sv)
+//         .EndArray()
+//     .EndDict();
+//
+// Контексты хранят только ссылку на Writer, их можно сохранять в переменные
+// и дописывать элементы в цикле.
+
+namespace stream_detail {
+
+inline void WriteValue(Writer& writer, std::nullptr_t) {
+    writer.Null();
+}
+
+inline void WriteValue(Writer& writer, bool value) {
+    writer.Bool(value);
+}
+
+inline void WriteValue(Writer& writer, int value) {
+    writer.Int(value);
+}
+
+inline void WriteValue(Writer& writer, double value) {
+    writer.Double(value);
+}
+
+inline void WriteValue(Writer& writer, std::string_view value) {
+    writer.String(value);
+}
+
+inline void WriteValue(Writer& writer, const std::string& value) {
+    writer.String(value);
+}
+
+inline void WriteValue(Writer& writer, const char* value) {
+    writer.String(value);
+}
+
+inline void WriteValue(Writer& writer, const Node& value) {
+    Print(value, writer);
+}
+
+// Значение верхнего уровня записано, продолжать нечего
+class Done {
+public:
+    explicit Done(Writer&) {
+    }
+};
+
+template <typename Parent> class DictItemContext;
+template <typename Parent> class DictValueContext;
+template <typename Parent> class ArrayItemContext;
+
+template <typename Parent>
+class DictItemContext {
+public:
+    explicit DictItemContext(Writer& writer)
+        : writer_(writer) {
+    }
+
+    DictValueContext<Parent> Key(std::string_view key) {
+        writer_.Key(key);
+        return DictValueContext<Parent>(writer_);
+    }
+
+    Parent EndDict() {
+        writer_.EndObject();
+        return Parent(writer_);
+    }
+
+private:
+    Writer& writer_;
+};
+
+template <typename Parent>
+class DictValueContext {
+public:
+    explicit DictValueContext(Writer& writer)
+        : writer_(writer) {
+    }
+
+    template <typename ValueType>
+    DictItemContext<Parent> Value(const ValueType& value) {
+        WriteValue(writer_, value);
+        return DictItemContext<Parent>(writer_);
+    }
+
+    DictItemContext<DictItemContext<Parent>> StartDict() {
+        writer_.StartObject();
+        return DictItemContext<DictItemContext<Parent>>(writer_);
+    }
+
+    ArrayItemContext<DictItemContext<Parent>> StartArray() {
+        writer_.StartArray();
+        return ArrayItemContext<DictItemContext<Parent>>(writer_);
+    }
+
+private:
+    Writer& writer_;
+};
+
+template <typename Parent>
+class ArrayItemContext {
+public:
+    explicit ArrayItemContext(Writer& writer)
+        : writer_(writer) {
+    }
+
+    template <typename ValueType>
+    ArrayItemContext Value(const ValueType& value) {
+        WriteValue(writer_, value);
+        return *this;
+    }
+
+    DictItemContext<ArrayItemContext> StartDict() {
+        writer_.StartObject();
+        return DictItemContext<ArrayItemContext>(writer_);
+    }
+
+    ArrayItemContext<ArrayItemContext> StartArray() {
+        writer_.StartArray();
+        return ArrayItemContext<ArrayItemContext>(writer_);
+    }
+
+    Parent EndArray() {
+        writer_.EndArray();
+        return Parent(writer_);
+    }
+
+private:
+    Writer& writer_;
+};
+
+}  // namespace stream_detail
+
+// Записывает одно значение в текущую позицию writer
+class StreamWriter {
+public:
+    explicit StreamWriter(Writer& writer)
+        : writer_(writer) {
+    }
+
+public:
+    stream_detail::DictItemContext<stream_detail::Done> StartDict() {
+        writer_.StartObject();
+        return stream_detail::DictItemContext<stream_detail::Done>(writer_);
+    }
+
+    stream_detail::ArrayItemContext<stream_detail::Done> StartArray() {
+        writer_.StartArray();
+        return stream_detail::ArrayItemContext<stream_detail::Done>(writer_);
+    }
+
+    template <typename ValueType>
+    stream_detail::Done Value(const ValueType& value) {
+        stream_detail::WriteValue(writer_, value);
+        return stream_detail::Done(writer_);
+    }
+
+private:
+    Writer& writer_;
+};
+
+}  // namespace json
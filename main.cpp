@@ -1,19 +1,209 @@
 #include "transport_catalogue.h"
 #include "json_reader.h"
+#include "metrics.h"
 #include "map_renderer.h"
 #include "transport_router.h"
+#include "query_server.h"
+#include "scheduler.h"
+#include "thread_pool.h"
 
-int main() {
+#include <charconv>
+#include <iostream>
+#include <memory_resource>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
 
+namespace {
+using namespace std::literals;
+
+constexpr std::string_view kUsage =
+    "Usage: transport_catalogue [options] < requests.json\n"
+    "  --help                 show this message\n"
+    "  --compact              compact JSON output\n"
+    "  --pipeline             execute stat requests in a pipeline\n"
+    "  --parallel             execute stat requests on a thread pool\n"
+    "  --workers N            number of worker threads (0 - hardware threads)\n"
+    "  --verbose              print execution summary and metrics to stderr\n"
+    "  --lazy                 load the requests document into a token tape first\n"
+    "  --jsonl BASE           answer JSON Lines requests from stdin using BASE\n"
+    "  --binary BASE          answer binary protocol requests from stdin using BASE\n"
+    "  --serve SOCKET         serve requests on a Unix socket\n"
+    "  --route-limit N        concurrent Route requests in server mode\n"
+    "  --map-limit N          concurrent Map requests in server mode\n"sv;
+
+struct Options {
+    bool help = false;
+    bool compact = false;
+    // Путь к документу с base_requests для режима JSON Lines
+    const char* jsonl_base = nullptr;
+    // Путь к документу с base_requests для двоичного протокола
+    const char* binary_base = nullptr;
+    // Путь к Unix-сокету для режима сервера
+    const char* socket_path = nullptr;
+    size_t workers_count = 0u;
+    // Ограничения сервера на одновременные запросы Route и Map, 0 - по умолчанию
+    size_t route_limit = 0u;
+    size_t map_limit = 0u;
+    // Пакетный режим: выполнять stat_requests пулом из workers_count потоков
+    bool parallel = false;
+    // Выполнять stat-запросы конвейером на workers_count потоках
+    bool use_pipeline = false;
+    // Сводка о выполнении и метрики в stderr при завершении
+    bool verbose = false;
+    // Загружать документ запросов через json::LazyDocument
+    bool lazy = false;
+};
+
+// Целое без знака целиком, без пробелов и знака минус
+size_t ParseCount(std::string_view option, std::string_view value) {
+    size_t result = 0u;
+    const auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), result);
+    if (value.empty() || ec != std::errc{} || ptr != value.data() + value.size()) {
+        throw std::invalid_argument("Invalid value '"s + std::string(value) + "' for "s + std::string(option));
+    }
+    return result;
+}
+
+// Бросает std::invalid_argument при неизвестном аргументе или неверном значении
+Options ParseOptions(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        auto value = [&]() -> std::string_view {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("Missing value for "s + std::string(arg));
+            }
+            return argv[++i];
+        };
+
+        if (arg == "--help"sv) {
+            options.help = true;
+        }
+        else if (arg == "--compact"sv) {
+            options.compact = true;
+        }
+        else if (arg == "--jsonl"sv) {
+            options.jsonl_base = value().data();
+        }
+        else if (arg == "--binary"sv) {
+            options.binary_base = value().data();
+        }
+        else if (arg == "--serve"sv) {
+            options.socket_path = value().data();
+        }
+        else if (arg == "--pipeline"sv) {
+            options.use_pipeline = true;
+        }
+        else if (arg == "--verbose"sv) {
+            options.verbose = true;
+        }
+        else if (arg == "--lazy"sv) {
+            options.lazy = true;
+        }
+        else if (arg == "--parallel"sv) {
+            options.parallel = true;
+        }
+        else if (arg == "--workers"sv) {
+            options.workers_count = ParseCount(arg, value());
+        }
+        else if (arg == "--route-limit"sv) {
+            options.route_limit = ParseCount(arg, value());
+        }
+        else if (arg == "--map-limit"sv) {
+            options.map_limit = ParseCount(arg, value());
+        }
+        else {
+            throw std::invalid_argument("Unknown argument '"s + std::string(arg) + "'"s);
+        }
+    }
+    return options;
+}
+
+// Документ запросов: base_path для JSON Lines и двоичного протокола, иначе stdin
+json_reader::JSONReader LoadRequests(const Options& options, std::pmr::memory_resource& arena) {
+    const char* base_path = options.jsonl_base ? options.jsonl_base : options.binary_base;
+    if (options.lazy) {
+        return base_path
+            ? json_reader::JSONReader(json::LoadLazyFile(base_path))
+            : json_reader::JSONReader(json::LoadLazy(std::cin));
+    }
+    return base_path
+        ? json_reader::JSONReader(json::LoadFile(base_path))
+        : json_reader::JSONReader(std::cin, arena);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    try {
+        options = ParseOptions(argc, argv);
+    }
+    catch (const std::invalid_argument& e) {
+        std::cerr << e.what() << "\n\n"sv << kUsage;
+        return 2;
+    }
+    if (options.help) {
+        std::cout << kUsage;
+        return 0;
+    }
+
+    // Настройки из документа запросов живут до конца программы и освобождаются вместе с ареной
+    std::pmr::monotonic_buffer_resource arena;
     tc::TransportCatalogue catalog;
-    json::Document doc(json::Load(std::cin));
-    json_reader::JSONReader json(doc);
+    json_reader::JSONReader json = LoadRequests(options, arena);
     map_render::MapRender map_render(json.GetRenderSettings());
+    catalog.SetDistanceMode(json.GetDistanceMode());
     json.LoadDataToTC(catalog);
 
     transport_router::TransportRouter router(catalog, json.GetRouteSettings());
-    handler::RequestHandler handler(catalog, map_render, router);
+    std::optional<thread_pool::ThreadPool> pool;
+    if (options.parallel && !options.socket_path) {
+        pool.emplace(options.workers_count);
+    }
+    handler::RequestHandler handler(catalog, map_render, router, pool ? &*pool : nullptr);
+
+    if (options.socket_path) {
+        scheduler::Limits limits = scheduler::GetDefaultLimits(options.workers_count);
+        if (options.route_limit) {
+            limits[static_cast<size_t>(scheduler::CostClass::kRoute)] = options.route_limit;
+        }
+        if (options.map_limit) {
+            limits[static_cast<size_t>(scheduler::CostClass::kMap)] = options.map_limit;
+        }
+        query_server::QueryServer server(json, handler, options.workers_count, limits);
+        server.Run(options.socket_path);
+    }
+    else if (options.binary_base) {
+        std::ios::sync_with_stdio(false);
+        handler.ServeBinary(std::cin, std::cout);
+    }
+    else if (options.jsonl_base) {
+        // Справочник построен один раз, дальше stdin читается построчно
+        std::ios::sync_with_stdio(false);
+        if (options.use_pipeline) {
+            json.ServeJsonLinesPipelined(std::cin, std::cout, handler, options.workers_count);
+        }
+        else {
+            json.ServeJsonLines(std::cin, std::cout, handler);
+        }
+    }
+    else {
+        json::PrintSettings print_settings = json.GetPrintSettings();
+        print_settings.compact = print_settings.compact || options.compact;
 
-    json.PrintStats(std::cout, handler.GetStats(json.GetStatCommands()));
+        if (options.use_pipeline) {
+            json.PrintStatsPipelined(std::cout, handler, json.GetStatCommands(), print_settings, options.workers_count);
+        }
+        else {
+            json.PrintStats(std::cout, handler, json.GetStatCommands(), print_settings);
+        }
+    }
 
-}
\ No newline at end of file
+    if (options.verbose) {
+        std::cerr << "Duplicate requests collapsed: "sv << handler.GetCollapsedCount() << '\n';
+        metrics::Dump(std::cerr);
+    }
+}
@@ -66,6 +66,12 @@ MapRender::MapRender(RenderSettings settings)
     : settings_(std::move(settings)) {
 }
 
+svg::NumberFormat MapRender::GetNumberFormat() const {
+    svg::NumberFormat format;
+    format.decimals = settings_.coordinate_decimals;
+    return format;
+}
+
 svg::Document MapRender::GetMapForTC(std::vector<domain::StopPtr> stops, std::vector<domain::BusPtr> buses) const {
     buses.erase(
         std::remove_if(buses.begin(), buses.end(), [](auto ptr) {return ptr->stops.empty(); }), buses.end()
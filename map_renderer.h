@@ -22,6 +22,8 @@ struct RenderSettings {
     svg::Color underlayer_color;
     double underlayer_width = 0.0;
     std::vector<svg::Color> color_palette;
+    // Знаков после запятой в координатах карты, по умолчанию - 6 значащих цифр
+    std::optional<int> coordinate_decimals;
 };
 
 class SphereProjector;
@@ -30,6 +32,7 @@ class MapRender {
 public:
     MapRender(RenderSettings settings);
     svg::Document GetMapForTC(std::vector<domain::StopPtr> stops, std::vector<domain::BusPtr> buses) const;
+    svg::NumberFormat GetNumberFormat() const;
 
 private:
     template <typename Obj>
@@ -0,0 +1,164 @@
+#include "metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string_view>
+
+namespace metrics {
+using namespace std::literals;
+
+namespace {
+
+constexpr std::array<std::string_view, static_cast<size_t>(Counter::kCount)> kCounterNames{
+    "route_lookups"sv,
+    "routes_not_found"sv,
+    "map_renders"sv,
+    "map_cache_hits"sv,
+    "collapsed_requests"sv,
+    "bytes_emitted"sv
+};
+
+constexpr std::array<std::string_view, static_cast<size_t>(Timer::kCount)> kTimerNames{
+    "Stop"sv,
+    "Bus"sv,
+    "Map"sv,
+    "Route"sv,
+    "Metrics"sv,
+    "router.get_route"sv,
+    "catalogue.get_stat"sv,
+    "renderer.get_map"sv,
+    "router.build"sv
+};
+
+std::array<std::atomic<uint64_t>, static_cast<size_t>(Counter::kCount)> counters{};
+std::array<Histogram, static_cast<size_t>(Timer::kCount)> histograms;
+
+size_t GetHighestBit(uint64_t value) {
+    size_t bit = 0u;
+    while (value >>= 1u) {
+        ++bit;
+    }
+    return bit;
+}
+
+}  // namespace
+
+// ---------- Histogram ------------------------------------------------------------
+
+void Histogram::Record(uint64_t value) {
+    buckets_[GetBucketIndex(value)].fetch_add(1u, std::memory_order_relaxed);
+    count_.fetch_add(1u, std::memory_order_relaxed);
+    total_.fetch_add(value, std::memory_order_relaxed);
+
+    uint64_t max = max_.load(std::memory_order_relaxed);
+    while (value > max && !max_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t Histogram::GetCount() const {
+    return count_.load(std::memory_order_relaxed);
+}
+
+uint64_t Histogram::GetTotal() const {
+    return total_.load(std::memory_order_relaxed);
+}
+
+uint64_t Histogram::GetMax() const {
+    return max_.load(std::memory_order_relaxed);
+}
+
+uint64_t Histogram::GetPercentile(double percentile) const {
+    const uint64_t count = GetCount();
+    if (count == 0u) {
+        return 0u;
+    }
+
+    // Ранг ближайшего сверху: наименьший k, при котором k/count >= percentile/100
+    const double exact_rank = std::ceil(percentile * static_cast<double>(count) / 100.0);
+    const uint64_t rank = exact_rank < 1.0 ? 1u : std::min(static_cast<uint64_t>(exact_rank), count);
+    uint64_t seen = 0u;
+    for (size_t i = 0u; i < kBucketsCount; ++i) {
+        seen += buckets_[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            return std::min(GetBucketUpperBound(i), GetMax());
+        }
+    }
+    return GetMax();
+}
+
+size_t Histogram::GetBucketIndex(uint64_t value) {
+    if (value < kSubBuckets) {
+        return static_cast<size_t>(value);
+    }
+    const size_t bit = GetHighestBit(value);
+    const size_t shift = bit - kSubBucketBits;
+    return (bit - kSubBucketBits + 1u) * kSubBuckets + ((value >> shift) & (kSubBuckets - 1u));
+}
+
+uint64_t Histogram::GetBucketUpperBound(size_t index) {
+    if (index < kSubBuckets) {
+        return index;
+    }
+    const size_t shift = index / kSubBuckets - 1u;
+    const uint64_t lower = (kSubBuckets + index % kSubBuckets) << shift;
+    return lower + ((uint64_t{ 1u } << shift) - 1u);
+}
+
+// ---------- Registry ------------------------------------------------------------
+
+Histogram& GetHistogram(Timer timer) {
+    return histograms[static_cast<size_t>(timer)];
+}
+
+std::atomic<uint64_t>& GetCounter(Counter counter) {
+    return counters[static_cast<size_t>(counter)];
+}
+
+domain::MetricsStat GetSnapshot() {
+    domain::MetricsStat result;
+    result.enabled = kEnabled;
+
+    for (size_t i = 0u; i < kCounterNames.size(); ++i) {
+        result.counters.push_back({ std::string(kCounterNames[i]), counters[i].load(std::memory_order_relaxed) });
+    }
+
+    for (size_t i = 0u; i < kTimerNames.size(); ++i) {
+        const Histogram& histogram = histograms[i];
+        domain::HistogramStat stat;
+        stat.name = kTimerNames[i];
+        stat.count = histogram.GetCount();
+        stat.total = histogram.GetTotal();
+        stat.max = histogram.GetMax();
+        stat.p50 = histogram.GetPercentile(50.0);
+        stat.p90 = histogram.GetPercentile(90.0);
+        stat.p99 = histogram.GetPercentile(99.0);
+        result.histograms.push_back(std::move(stat));
+    }
+
+    return result;
+}
+
+void Dump(std::ostream& output) {
+    if (!kEnabled) {
+        output << "Metrics are disabled (TC_METRICS=0)\n"sv;
+        return;
+    }
+
+    const domain::MetricsStat snapshot = GetSnapshot();
+    for (const auto& [name, value] : snapshot.counters) {
+        output << name << ": "sv << value << '\n';
+    }
+    for (const domain::HistogramStat& stat : snapshot.histograms) {
+        if (stat.count == 0u) {
+            continue;
+        }
+        output << stat.name << ": count "sv << stat.count
+            << ", mean "sv << stat.total / stat.count
+            << " ns, p50 "sv << stat.p50
+            << " ns, p90 "sv << stat.p90
+            << " ns, p99 "sv << stat.p99
+            << " ns, max "sv << stat.max << " ns\n"sv;
+    }
+}
+
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+
+#include "domain.h"
+
+// Счётчики и гистограммы задержек выполнения запросов.
+// Сборка с -DTC_METRICS=0 убирает весь учёт: функции ниже становятся пустыми.
+#ifndef TC_METRICS
+#define TC_METRICS 1
+#endif
+
+namespace metrics {
+
+inline constexpr bool kEnabled = TC_METRICS != 0;
+
+enum class Counter {
+    kRouteLookups,
+    kRoutesNotFound,
+    kMapRenders,
+    kMapCacheHits,
+    kCollapsedRequests,
+    kBytesEmitted,
+    kCount
+};
+
+// Первые значения совпадают с reader::QueryType: задержки запросов по типам
+enum class Timer {
+    kStopRequest,
+    kBusRequest,
+    kMapRequest,
+    kRouteRequest,
+    kMetricsRequest,
+    kGetRoute,
+    kGetBusStat,
+    kRenderMap,
+    kBuildRouter,
+    kCount
+};
+
+// Гистограмма в духе HDR: значения до 16 учитываются точно, дальше каждый
+// интервал [2^k, 2^(k+1)) делится на 16 равных корзин, т. е. относительная
+// погрешность не больше 1/16. Запись - несколько relaxed-операций без блокировок.
+class Histogram {
+public:
+    void Record(uint64_t value);
+
+    uint64_t GetCount() const;
+    uint64_t GetTotal() const;
+    uint64_t GetMax() const;
+    // Верхняя граница корзины, в которую попадает заданный процентиль
+    uint64_t GetPercentile(double percentile) const;
+
+private:
+    static constexpr size_t kSubBuckets = 16u;
+    static constexpr size_t kSubBucketBits = 4u;
+    static constexpr size_t kBucketsCount = (64u - kSubBucketBits + 1u) * kSubBuckets;
+
+    static size_t GetBucketIndex(uint64_t value);
+    static uint64_t GetBucketUpperBound(size_t index);
+
+    std::array<std::atomic<uint64_t>, kBucketsCount> buckets_{};
+    std::atomic<uint64_t> count_{ 0u };
+    std::atomic<uint64_t> total_{ 0u };
+    std::atomic<uint64_t> max_{ 0u };
+};
+
+Histogram& GetHistogram(Timer timer);
+std::atomic<uint64_t>& GetCounter(Counter counter);
+
+inline void Add(Counter counter, uint64_t value = 1u) {
+    if constexpr (kEnabled) {
+        GetCounter(counter).fetch_add(value, std::memory_order_relaxed);
+    }
+}
+
+inline Timer GetRequestTimer(reader::QueryType type) {
+    return static_cast<Timer>(type);
+}
+
+// Записывает время жизни объекта в наносекундах в гистограмму таймера
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Timer timer)
+        : timer_(timer) {
+        if constexpr (kEnabled) {
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    ~ScopedTimer() {
+        if constexpr (kEnabled) {
+            const auto elapsed = std::chrono::steady_clock::now() - start_;
+            GetHistogram(timer_).Record(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        }
+    }
+
+private:
+    Timer timer_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+// Текущие значения всех счётчиков и гистограмм
+domain::MetricsStat GetSnapshot();
+// Выводит снимок в читаемом виде, например в std::cerr при завершении
+void Dump(std::ostream& output);
+
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace detail {
+
+// Наименьшая степень двойки, не меньшая 2 * count
+constexpr size_t PerfectHashTableSize(size_t count) {
+    size_t size = 1u;
+    while (size < 2u * count) {
+        size *= 2u;
+    }
+    return size;
+}
+
+// Совершенная хеш-функция над фиксированным набором строк. Затравка подбирается
+// при компиляции так, чтобы все ключи попали в разные ячейки таблицы, поэтому
+// поиск - это один хеш и одно сравнение строк.
+//
+//     static constexpr PerfectHash<2> kKeys({ "name"sv, "type"sv });
+//     kKeys.Find("type"sv) == 1
+template <size_t N>
+class PerfectHash {
+public:
+    static constexpr size_t kNotFound = N;
+
+    constexpr explicit PerfectHash(const std::array<std::string_view, N>& keys)
+        : keys_(keys) {
+        while (!TryBuild(seed_)) {
+            ++seed_;
+        }
+    }
+
+    // Номер ключа в исходном массиве или kNotFound
+    constexpr size_t Find(std::string_view key) const {
+        const size_t index = slots_[Hash(key, seed_) & (kTableSize - 1u)];
+        return index != kNotFound && keys_[index] == key ? index : kNotFound;
+    }
+
+    constexpr std::string_view GetKey(size_t index) const {
+        return keys_[index];
+    }
+
+private:
+    static constexpr size_t kTableSize = PerfectHashTableSize(N);
+
+    // FNV-1a с примешанной затравкой
+    static constexpr uint32_t Hash(std::string_view key, uint32_t seed) {
+        uint32_t hash = 2166136261u ^ (seed * 0x9E3779B9u);
+        for (const char c : key) {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= 16777619u;
+        }
+        return hash ^ (hash >> 15);
+    }
+
+    constexpr bool TryBuild(uint32_t seed) {
+        for (size_t& slot : slots_) {
+            slot = kNotFound;
+        }
+        for (size_t i = 0; i < N; ++i) {
+            size_t& slot = slots_[Hash(keys_[i], seed) & (kTableSize - 1u)];
+            if (slot != kNotFound) {
+                return false;
+            }
+            slot = i;
+        }
+        return true;
+    }
+
+private:
+    std::array<std::string_view, N> keys_{};
+    std::array<size_t, kTableSize> slots_{};
+    uint32_t seed_ = 1u;
+};
+
+}
@@ -0,0 +1,457 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace pipeline {
+
+// Место, где простаивающие стадии спят до изменения состояния конвейера.
+// Ждущий запоминает номер события (GetEpoch) до проверки своего условия и, если
+// оно не выполнено, спит в Wait, пока кто-нибудь не вызовет Notify после этого номера.
+// Пока никто не спит, Notify не трогает мьютекс.
+class Parking {
+public:
+    uint64_t GetEpoch() const {
+        return epoch_.load(std::memory_order_seq_cst);
+    }
+
+    void Wait(uint64_t epoch) {
+        std::unique_lock lock(mutex_);
+        waiters_.fetch_add(1u, std::memory_order_seq_cst);
+        ready_.wait(lock, [this, epoch] {
+            return epoch_.load(std::memory_order_seq_cst) != epoch;
+        });
+        waiters_.fetch_sub(1u, std::memory_order_relaxed);
+    }
+
+    void Notify() {
+        epoch_.fetch_add(1u, std::memory_order_seq_cst);
+        if (waiters_.load(std::memory_order_seq_cst) != 0u) {
+            // Ждущий между проверкой номера и засыпанием держит мьютекс
+            { std::lock_guard lock(mutex_); }
+            ready_.notify_all();
+        }
+    }
+
+private:
+    std::atomic<uint64_t> epoch_{ 0u };
+    std::atomic<size_t> waiters_{ 0u };
+    std::mutex mutex_;
+    std::condition_variable ready_;
+};
+
+// Ожидание в циклах опроса: сначала поток уступает процессор,
+// затем засыпает в Parking, чтобы простаивающая стадия не занимала ядро
+class Backoff {
+public:
+    explicit Backoff(Parking& parking)
+        : parking_(&parking) {
+    }
+
+    // epoch - номер события, полученный до неудачной проверки условия
+    void Pause(uint64_t epoch) {
+        if (spins_ < kYieldSpins) {
+            ++spins_;
+            std::this_thread::yield();
+        }
+        else {
+            parking_->Wait(epoch);
+        }
+    }
+
+    void Reset() {
+        spins_ = 0u;
+    }
+
+private:
+    static constexpr unsigned kYieldSpins = 64u;
+
+    Parking* parking_;
+    unsigned spins_ = 0u;
+};
+
+// Что делать с потоком source, если конвейер остановлен ошибкой, пока source работает
+enum class SourceOnError {
+    // Дождаться возврата из source
+    kJoin,
+    // Не ждать: source, читающий внешний ввод, может не вернуться долго.
+    // Поток отсоединяется и завершается сам, когда source вернёт управление,
+    // поэтому source должен обращаться только к объектам, живущим дольше Run.
+    kDetach
+};
+
+// Источник заданий, от ожидания которого Run может отказаться.
+// Общий для Run и потока source, чтобы отсоединённый поток не обращался к конвейеру.
+template <typename Source>
+class Feeder {
+public:
+    explicit Feeder(Source source)
+        : source_(std::move(source)) {
+    }
+
+public:
+    // Вызывает source(input). nullopt - Run отказался от источника,
+    // и конвейер уже может быть разрушен.
+    template <typename Input>
+    std::optional<bool> Next(Input& input) {
+        {
+            std::lock_guard lock(mutex_);
+            if (abandoned_) {
+                return std::nullopt;
+            }
+            in_source_ = true;
+        }
+        bool has_input = false;
+        std::exception_ptr error;
+        try {
+            has_input = source_(input);
+        }
+        catch (...) {
+            error = std::current_exception();
+        }
+        {
+            std::lock_guard lock(mutex_);
+            in_source_ = false;
+            if (abandoned_) {
+                return std::nullopt;
+            }
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return has_input;
+    }
+
+    // Запрещает новые вызовы source. true, если source сейчас выполняется:
+    // тогда поток источника можно не ждать, иначе он скоро завершится сам.
+    bool Abandon() {
+        std::lock_guard lock(mutex_);
+        abandoned_ = true;
+        return in_source_;
+    }
+
+private:
+    Source source_;
+    std::mutex mutex_;
+    bool in_source_ = false;
+    bool abandoned_ = false;
+};
+
+// Ограниченная очередь без блокировок для нескольких писателей и читателей.
+// Каждая ячейка хранит номер позиции, для которой она свободна или заполнена,
+// поэтому писатели и читатели захватывают позиции одним compare_exchange.
+template <typename T>
+class BoundedQueue {
+public:
+    // Ёмкость округляется вверх до степени двойки
+    explicit BoundedQueue(size_t capacity) {
+        size_t size = 2u;
+        while (size < capacity) {
+            size *= 2u;
+        }
+        cells_ = std::make_unique<Cell[]>(size);
+        mask_ = size - 1u;
+        for (size_t i = 0u; i < size; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+public:
+    // При успехе забирает value, при заполненной очереди возвращает false и не трогает его
+    bool TryPush(T& value) {
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells_[pos & mask_];
+            const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1u, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if (diff < 0) {
+                return false;
+            }
+            else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = std::move(value);
+        cell->sequence.store(pos + 1u, std::memory_order_release);
+        return true;
+    }
+
+    bool TryPop(T& value) {
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells_[pos & mask_];
+            const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos + 1u);
+            if (diff == 0) {
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1u, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if (diff < 0) {
+                return false;
+            }
+            else {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        value = std::move(cell->value);
+        cell->sequence.store(pos + mask_ + 1u, std::memory_order_release);
+        return true;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence{ 0u };
+        T value{};
+    };
+
+    std::unique_ptr<Cell[]> cells_;
+    size_t mask_ = 0u;
+    // Позиции писателей и читателей в разных кэш-линиях
+    alignas(64) std::atomic<size_t> enqueue_pos_{ 0u };
+    alignas(64) std::atomic<size_t> dequeue_pos_{ 0u };
+};
+
+constexpr size_t kDefaultCapacity = 256u;
+
+// Конвейер из трёх стадий:
+//   source (свой поток) -> execute (executors_count потоков) -> sink (вызывающий поток).
+// Задания передаются исполнителям через BoundedQueue, результаты собираются
+// в кольцо из capacity ячеек по номеру задания, так что sink получает их в порядке
+// source. Исполнители не опережают вывод больше чем на capacity заданий.
+template <typename Input, typename Output>
+class Pipeline {
+public:
+    // executors_count = 0 означает число аппаратных потоков
+    explicit Pipeline(size_t executors_count = 0u, size_t capacity = kDefaultCapacity)
+        : executors_count_(executors_count ? executors_count : std::max(1u, std::thread::hardware_concurrency()))
+        , capacity_(std::max<size_t>(capacity, 1u))
+        , queue_(capacity_)
+        , slots_(std::make_unique<Slot[]>(capacity_)) {
+    }
+
+public:
+    // source(Input&) заполняет очередное задание и возвращает false в конце ввода,
+    // execute(Input&&) возвращает Output, sink(Output&) выводит результат.
+    // Исключение любой стадии останавливает конвейер и передаётся вызывающему.
+    // source копируется в поток источника. Объект рассчитан на один запуск.
+    template <typename Source, typename Execute, typename Sink>
+    void Run(Source&& source, Execute&& execute, Sink&& sink, SourceOnError on_error = SourceOnError::kJoin) {
+        auto feeder = std::make_shared<Feeder<std::decay_t<Source>>>(std::forward<Source>(source));
+        std::thread feed_thread([this, feeder] {
+            Feed(*feeder);
+        });
+
+        std::vector<std::thread> executors;
+        executors.reserve(executors_count_);
+        for (size_t i = 0u; i < executors_count_; ++i) {
+            executors.emplace_back([this, &execute] {
+                ExecuteTasks(execute);
+            });
+        }
+
+        Drain(sink);
+
+        stopped_.store(true, std::memory_order_release);
+        parking_.Notify();
+        for (std::thread& thread : executors) {
+            thread.join();
+        }
+        if (on_error == SourceOnError::kDetach && GetError() && feeder->Abandon()) {
+            feed_thread.detach();
+        }
+        else {
+            feed_thread.join();
+        }
+
+        if (const std::exception_ptr error = GetError()) {
+            std::rethrow_exception(error);
+        }
+    }
+
+private:
+    struct Task {
+        size_t index = 0u;
+        Input input{};
+    };
+
+    struct Slot {
+        std::atomic<bool> ready{ false };
+        Output output{};
+    };
+
+    bool IsStopped() const {
+        return stopped_.load(std::memory_order_acquire);
+    }
+
+    void Fail() {
+        {
+            std::lock_guard lock(error_mutex_);
+            if (!error_) {
+                error_ = std::current_exception();
+            }
+        }
+        stopped_.store(true, std::memory_order_release);
+        parking_.Notify();
+    }
+
+    std::exception_ptr GetError() {
+        std::lock_guard lock(error_mutex_);
+        return error_;
+    }
+
+    template <typename Source>
+    void Feed(Feeder<Source>& feeder) {
+        Task task;
+        Backoff backoff(parking_);
+        size_t index = 0u;
+        try {
+            while (!IsStopped()) {
+                task.index = index;
+                const std::optional<bool> has_input = feeder.Next(task.input);
+                if (!has_input) {
+                    // Run уже вернул управление, конвейер может быть разрушен
+                    return;
+                }
+                if (!*has_input) {
+                    break;
+                }
+                while (true) {
+                    const uint64_t epoch = parking_.GetEpoch();
+                    if (queue_.TryPush(task)) {
+                        break;
+                    }
+                    if (IsStopped()) {
+                        return;
+                    }
+                    backoff.Pause(epoch);
+                }
+                parking_.Notify();
+                backoff.Reset();
+                ++index;
+            }
+        }
+        catch (...) {
+            Fail();
+        }
+        total_.store(index, std::memory_order_relaxed);
+        input_done_.store(true, std::memory_order_release);
+        parking_.Notify();
+    }
+
+    template <typename Execute>
+    void ExecuteTasks(Execute& execute) {
+        Task task;
+        Backoff backoff(parking_);
+        while (!IsStopped()) {
+            const uint64_t epoch = parking_.GetEpoch();
+            if (!queue_.TryPop(task)) {
+                if (!input_done_.load(std::memory_order_acquire)) {
+                    backoff.Pause(epoch);
+                    continue;
+                }
+                // Все задания помещаются в очередь до установки input_done_
+                if (!queue_.TryPop(task)) {
+                    return;
+                }
+            }
+            // Освободилось место в очереди для source
+            parking_.Notify();
+            backoff.Reset();
+
+            // Ячейка освобождается, когда вывод дойдёт до задания index - capacity_
+            while (true) {
+                const uint64_t epoch = parking_.GetEpoch();
+                if (task.index < emitted_.load(std::memory_order_acquire) + capacity_) {
+                    break;
+                }
+                if (IsStopped()) {
+                    return;
+                }
+                backoff.Pause(epoch);
+            }
+            backoff.Reset();
+
+            Slot& slot = slots_[task.index % capacity_];
+            try {
+                slot.output = execute(std::move(task.input));
+            }
+            catch (...) {
+                Fail();
+                return;
+            }
+            slot.ready.store(true, std::memory_order_release);
+            parking_.Notify();
+        }
+    }
+
+    template <typename Sink>
+    void Drain(Sink& sink) {
+        Backoff backoff(parking_);
+        size_t next = 0u;
+        while (true) {
+            const uint64_t epoch = parking_.GetEpoch();
+            Slot& slot = slots_[next % capacity_];
+            if (slot.ready.load(std::memory_order_acquire)) {
+                try {
+                    sink(slot.output);
+                }
+                catch (...) {
+                    Fail();
+                    return;
+                }
+                slot.output = Output{};
+                slot.ready.store(false, std::memory_order_relaxed);
+                emitted_.store(++next, std::memory_order_release);
+                parking_.Notify();
+                backoff.Reset();
+                continue;
+            }
+            if (IsStopped()) {
+                return;
+            }
+            if (input_done_.load(std::memory_order_acquire) && next == total_.load(std::memory_order_relaxed)) {
+                return;
+            }
+            backoff.Pause(epoch);
+        }
+    }
+
+private:
+    const size_t executors_count_;
+    const size_t capacity_;
+    BoundedQueue<Task> queue_;
+    std::unique_ptr<Slot[]> slots_;
+
+    std::atomic<bool> stopped_{ false };
+    std::atomic<bool> input_done_{ false };
+    std::atomic<size_t> total_{ 0u };
+    std::atomic<size_t> emitted_{ 0u };
+    Parking parking_;
+
+    std::mutex error_mutex_;
+    std::exception_ptr error_;
+};
+
+}
@@ -0,0 +1,475 @@
+#include "query_server.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#ifdef __linux__
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace query_server {
+using namespace std::literals;
+
+QueryServer::QueryServer(const json_reader::JSONReader& reader, const handler::RequestHandler& handler,
+    size_t workers_count, scheduler::Limits limits)
+    : reader_(reader)
+    , handler_(handler)
+    , workers_count_(workers_count ? workers_count : std::max(1u, std::thread::hardware_concurrency()))
+    , limits_(limits) {
+}
+
+#ifdef __linux__
+
+namespace {
+
+// Строка длиннее этого считается ошибкой клиента, соединение закрывается
+constexpr size_t kMaxLineSize = 1u << 20;
+constexpr size_t kReadBlockSize = 1u << 16;
+// Пока у клиента столько невыполненных запросов или неотправленных байт,
+// его сокет не читается: клиент, не забирающий ответы, не расходует память сервера
+constexpr size_t kMaxPendingRequests = 1024u;
+constexpr size_t kMaxOutputSize = 4u << 20;
+
+// Метки событий epoll, не относящихся к клиентам. Клиенты нумеруются с kFirstClientId.
+constexpr uint64_t kListenId = 0u;
+constexpr uint64_t kWakeId = 1u;
+constexpr uint64_t kSignalId = 2u;
+constexpr uint64_t kFirstClientId = 3u;
+
+// Запрос разбирается при чтении, чтобы поставить его в очередь своего класса стоимости
+struct Task {
+    uint64_t client_id = 0u;
+    std::optional<reader::StatCommand> command;
+    // Ошибка разбора и номер запроса, если он успел разобраться
+    std::optional<int> error_id;
+    std::string error;
+};
+
+struct Answer {
+    uint64_t client_id = 0u;
+    std::string text;
+};
+
+class FileDescriptor {
+public:
+    explicit FileDescriptor(int fd = -1)
+        : fd_(fd) {
+    }
+    FileDescriptor(const FileDescriptor&) = delete;
+    FileDescriptor& operator=(const FileDescriptor&) = delete;
+    ~FileDescriptor() {
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+    }
+
+    int Get() const {
+        return fd_;
+    }
+
+private:
+    int fd_;
+};
+
+// Готовые ответы, которые рабочие потоки передают циклу событий
+class AnswerQueue {
+public:
+    explicit AnswerQueue(int wake_fd)
+        : wake_fd_(wake_fd) {
+    }
+
+    void Push(Answer answer) {
+        {
+            std::lock_guard lock(mutex_);
+            answers_.push_back(std::move(answer));
+        }
+        const uint64_t one = 1u;
+        [[maybe_unused]] const ssize_t written = write(wake_fd_, &one, sizeof(one));
+    }
+
+    std::vector<Answer> TakeAll() {
+        uint64_t counter = 0u;
+        [[maybe_unused]] const ssize_t read_bytes = read(wake_fd_, &counter, sizeof(counter));
+        std::vector<Answer> result;
+        std::lock_guard lock(mutex_);
+        result.swap(answers_);
+        return result;
+    }
+
+private:
+    int wake_fd_;
+    std::mutex mutex_;
+    std::vector<Answer> answers_;
+};
+
+struct Client {
+    explicit Client(int client_fd)
+        : fd(client_fd) {
+    }
+
+    FileDescriptor fd;
+    std::string input;       // Прочитанные, но ещё не отданные пулу строки
+    std::string output;      // Ответы, которые не удалось отправить сразу
+    size_t pending = 0u;     // Запросы, отданные пулу и ещё не выполненные
+    bool read_closed = false;
+    uint32_t events = EPOLLIN;
+};
+
+bool IsThrottled(const Client& client) {
+    return client.pending >= kMaxPendingRequests || client.output.size() >= kMaxOutputSize;
+}
+
+bool IsBlank(std::string_view line) {
+    return line.find_first_not_of(" \t\r"sv) == std::string_view::npos;
+}
+
+void ThrowSystemError(const std::string& what) {
+    throw std::runtime_error(what + ": "s + std::strerror(errno));
+}
+
+// Удаляет файл сокета, оставшийся от прошлого запуска. Другие файлы не трогает.
+void RemoveStaleSocket(const std::string& path) {
+    struct stat st {};
+    if (lstat(path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode)) {
+        unlink(path.c_str());
+    }
+}
+
+void AddToEpoll(int epoll_fd, int fd, uint64_t id, uint32_t events) {
+    epoll_event event{};
+    event.events = events;
+    event.data.u64 = id;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+        ThrowSystemError("epoll_ctl failed"s);
+    }
+}
+
+class EventLoop {
+public:
+    EventLoop(const json_reader::JSONReader& reader, const handler::RequestHandler& handler,
+        int listen_fd, int signal_fd, size_t workers_count, const scheduler::Limits& limits)
+        : reader_(reader)
+        , handler_(handler)
+        , listen_fd_(listen_fd)
+        , signal_fd_(signal_fd)
+        , epoll_fd_(epoll_create1(EPOLL_CLOEXEC))
+        , wake_fd_(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+        , answers_(wake_fd_.Get())
+        , scheduler_(workers_count, limits) {
+        if (epoll_fd_.Get() < 0 || wake_fd_.Get() < 0) {
+            ThrowSystemError("Failed to create event loop"s);
+        }
+        AddToEpoll(epoll_fd_.Get(), listen_fd_, kListenId, EPOLLIN);
+        AddToEpoll(epoll_fd_.Get(), wake_fd_.Get(), kWakeId, EPOLLIN);
+        AddToEpoll(epoll_fd_.Get(), signal_fd, kSignalId, EPOLLIN);
+    }
+
+    void Run() {
+        try {
+            Loop();
+        }
+        catch (...) {
+            scheduler_.Close();
+            throw;
+        }
+        scheduler_.Close();
+    }
+
+private:
+    void Loop() {
+        std::vector<epoll_event> events(64);
+        bool stopped = false;
+        while (!stopped) {
+            const int count = epoll_wait(epoll_fd_.Get(), events.data(), static_cast<int>(events.size()), -1);
+            if (count < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                ThrowSystemError("epoll_wait failed"s);
+            }
+
+            for (int i = 0; i < count; ++i) {
+                const uint64_t id = events[i].data.u64;
+                if (id == kListenId) {
+                    Accept();
+                }
+                else if (id == kWakeId) {
+                    DeliverAnswers();
+                }
+                else if (id == kSignalId) {
+                    // Сигнал вычитывается, иначе он сработает после снятия маски
+                    signalfd_siginfo info{};
+                    [[maybe_unused]] const ssize_t read_bytes = read(signal_fd_, &info, sizeof(info));
+                    stopped = true;
+                }
+                else {
+                    HandleClient(id, events[i].events);
+                }
+            }
+        }
+    }
+
+    void Submit(uint64_t id, Client& client, std::string_view line) {
+        ++client.pending;
+        Task task;
+        task.client_id = id;
+        scheduler::CostClass cost_class = scheduler::CostClass::kLight;
+        try {
+            task.command = json_reader::RequestsDecoder::DecodeStatCommand(line);
+            cost_class = scheduler::GetCostClass(task.command->query_type);
+        }
+        catch (const json_reader::StatCommandError& e) {
+            task.error_id = e.GetId();
+            task.error = e.what();
+        }
+        scheduler_.Submit(cost_class, [this, task = std::move(task)] {
+            Work(task);
+        });
+    }
+
+    void Work(const Task& task) {
+        json::PrintSettings settings;
+        settings.compact = true;
+
+        std::ostringstream out;
+        {
+            json::Writer writer(out, settings);
+            if (task.command) {
+                reader_.AnswerCommand(*task.command, handler_, writer);
+            }
+            else {
+                reader_.AnswerError(task.error_id, task.error, writer);
+            }
+        }
+        out.put('\n');
+        answers_.Push({ task.client_id, out.str() });
+    }
+
+    void Accept() {
+        while (true) {
+            const int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                // EAGAIN - очередь подключений пуста, остальные ошибки касаются одного клиента
+                return;
+            }
+            const uint64_t id = next_client_id_++;
+            clients_.try_emplace(id, fd);
+            AddToEpoll(epoll_fd_.Get(), fd, id, EPOLLIN);
+        }
+    }
+
+    void HandleClient(uint64_t id, uint32_t events) {
+        const auto it = clients_.find(id);
+        if (it == clients_.end()) {
+            return;
+        }
+        Client& client = it->second;
+
+        // EPOLLHUP - собеседник закрыл соединение целиком, ответы читать некому.
+        // Оба события приходят и при пустой маске, так что клиент удаляется сразу;
+        // ответы его ещё выполняющихся запросов DeliverAnswers отбросит.
+        if (events & (EPOLLERR | EPOLLHUP)) {
+            clients_.erase(it);
+            return;
+        }
+        if ((events & EPOLLIN) && !Read(id, client)) {
+            clients_.erase(it);
+            return;
+        }
+        if ((events & EPOLLOUT) && !Send(client)) {
+            clients_.erase(it);
+            return;
+        }
+        Update(it);
+    }
+
+    // Читает доступные данные и отдаёт пулу полные строки. false - соединение надо закрыть.
+    bool Read(uint64_t id, Client& client) {
+        char buffer[kReadBlockSize];
+        while (!client.read_closed && !IsThrottled(client)) {
+            const ssize_t size = read(client.fd.Get(), buffer, sizeof(buffer));
+            if (size < 0) {
+                return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+            }
+            if (size == 0) {
+                client.read_closed = true;
+                break;
+            }
+
+            client.input.append(buffer, static_cast<size_t>(size));
+            SubmitLines(id, client);
+            // Без ограничения в input остаётся только недописанная строка
+            if (!IsThrottled(client) && client.input.size() > kMaxLineSize) {
+                return false;
+            }
+        }
+        SubmitLines(id, client);
+        return true;
+    }
+
+    // Отдаёт пулу полные строки из input, пока клиент не упрётся в ограничения
+    void SubmitLines(uint64_t id, Client& client) {
+        size_t begin = 0u;
+        while (!IsThrottled(client)) {
+            const size_t end = client.input.find('\n', begin);
+            if (end == std::string::npos) {
+                break;
+            }
+            const std::string_view line(client.input.data() + begin, end - begin);
+            if (!IsBlank(line)) {
+                Submit(id, client, line);
+            }
+            begin = end + 1;
+        }
+        client.input.erase(0, begin);
+
+        // Последняя строка может быть без перевода строки
+        if (client.read_closed && !IsThrottled(client) && client.input.find('\n') == std::string::npos) {
+            if (!IsBlank(client.input)) {
+                Submit(id, client, client.input);
+            }
+            client.input.clear();
+        }
+    }
+
+    // Отправляет накопленные ответы, сколько примет сокет. false - клиент отключился.
+    bool Send(Client& client) {
+        size_t sent = 0u;
+        while (sent < client.output.size()) {
+            const ssize_t size = send(client.fd.Get(), client.output.data() + sent,
+                client.output.size() - sent, MSG_NOSIGNAL);
+            if (size < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                    break;
+                }
+                return false;
+            }
+            sent += static_cast<size_t>(size);
+        }
+        client.output.erase(0, sent);
+        return true;
+    }
+
+    void DeliverAnswers() {
+        for (Answer& answer : answers_.TakeAll()) {
+            const auto it = clients_.find(answer.client_id);
+            if (it == clients_.end()) {
+                continue;
+            }
+            Client& client = it->second;
+            --client.pending;
+            client.output += answer.text;
+            if (!Send(client)) {
+                clients_.erase(it);
+                continue;
+            }
+            Update(it);
+        }
+    }
+
+    // Дочитывает отложенные строки, подписывается на нужные события
+    // или закрывает соединение, когда всё отвечено
+    void Update(std::unordered_map<uint64_t, Client>::iterator it) {
+        Client& client = it->second;
+        SubmitLines(it->first, client);
+        if (client.read_closed && client.input.empty() && client.pending == 0u && client.output.empty()) {
+            clients_.erase(it);
+            return;
+        }
+
+        const uint32_t events = (client.read_closed || IsThrottled(client) ? 0u : static_cast<uint32_t>(EPOLLIN))
+            | (client.output.empty() ? 0u : static_cast<uint32_t>(EPOLLOUT));
+        if (events != client.events) {
+            epoll_event event{};
+            event.events = events;
+            event.data.u64 = it->first;
+            epoll_ctl(epoll_fd_.Get(), EPOLL_CTL_MOD, client.fd.Get(), &event);
+            client.events = events;
+        }
+    }
+
+private:
+    const json_reader::JSONReader& reader_;
+    const handler::RequestHandler& handler_;
+    int listen_fd_;
+    int signal_fd_;
+    FileDescriptor epoll_fd_;
+    FileDescriptor wake_fd_;
+    AnswerQueue answers_;
+    std::unordered_map<uint64_t, Client> clients_;
+    uint64_t next_client_id_ = kFirstClientId;
+    // Последним: потоки планировщика обращаются к полям выше и останавливаются первыми
+    scheduler::PriorityScheduler scheduler_;
+};
+
+}  // namespace
+
+void QueryServer::Run(const std::string& socket_path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socket_path.empty() || socket_path.size() >= sizeof(address.sun_path)) {
+        throw std::invalid_argument("Invalid socket path "s + socket_path);
+    }
+    socket_path.copy(address.sun_path, socket_path.size());
+
+    // Сигналы остановки принимаются через signalfd. Маску нужно выставить
+    // до запуска рабочих потоков, чтобы они её унаследовали.
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    sigset_t old_signals;
+    pthread_sigmask(SIG_BLOCK, &signals, &old_signals);
+
+    try {
+        FileDescriptor signal_fd(signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC));
+        FileDescriptor listen_fd(socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0));
+        if (signal_fd.Get() < 0 || listen_fd.Get() < 0) {
+            ThrowSystemError("Failed to create socket"s);
+        }
+
+        RemoveStaleSocket(socket_path);
+        if (bind(listen_fd.Get(), reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0
+            || listen(listen_fd.Get(), SOMAXCONN) != 0) {
+            ThrowSystemError("Failed to listen on "s + socket_path);
+        }
+
+        EventLoop loop(reader_, handler_, listen_fd.Get(), signal_fd.Get(), workers_count_, limits_);
+        loop.Run();
+    }
+    catch (...) {
+        RemoveStaleSocket(socket_path);
+        pthread_sigmask(SIG_SETMASK, &old_signals, nullptr);
+        throw;
+    }
+
+    RemoveStaleSocket(socket_path);
+    pthread_sigmask(SIG_SETMASK, &old_signals, nullptr);
+}
+
+#else
+
+void QueryServer::Run(const std::string&) {
+    throw std::logic_error("Query server is supported only on Linux"s);
+}
+
+#endif
+
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "json_reader.h"
+#include "request_handler.h"
+#include "scheduler.h"
+
+namespace query_server {
+
+// Сервер запросов на локальном Unix-сокете (только Linux).
+// Каждое соединение передаёт stat-запросы в формате JSON Lines. Запросы
+// выполняются пулом потоков над общим неизменяемым справочником, поэтому
+// ответы одного соединения могут приходить не в порядке запросов:
+// их сопоставляют по request_id. Пул выбирает запросы по классам стоимости
+// (scheduler.h): Stop и Bus не ждут за Map и Route, а тяжёлые запросы
+// выполняются не больше чем на limits потоках.
+class QueryServer {
+public:
+    QueryServer(const json_reader::JSONReader& reader, const handler::RequestHandler& handler,
+        size_t workers_count = 0u, scheduler::Limits limits = scheduler::GetDefaultLimits(0u));
+
+public:
+    // Обслуживает клиентов до SIGINT или SIGTERM, после чего удаляет файл сокета
+    void Run(const std::string& socket_path);
+
+private:
+    const json_reader::JSONReader& reader_;
+    const handler::RequestHandler& handler_;
+    size_t workers_count_;
+    scheduler::Limits limits_;
+};
+
+}
@@ -1,24 +1,209 @@
 #include "request_handler.h"
+#include "binary_protocol.h"
+#include "metrics.h"
+#include "pipeline.h"
+
+#include <unordered_map>
 
 namespace handler {
 
-RequestHandler::RequestHandler(const tc::TransportCatalogue& db, const map_render::MapRender& renderer, const transport_router::TransportRouter& router)
+namespace {
+
+// Порций на участника пула: мелкие порции выравнивают нагрузку между потоками
+constexpr size_t kChunksPerThread = 4u;
+
+// Относительная стоимость запроса. Отрисовка карты и поиск маршрута на порядки
+// дороже поиска остановки или автобуса по имени.
+size_t EstimateCost(const StatCommand& command) {
+    switch (command.query_type) {
+    case QueryType::kMap:
+        return 256u;
+    case QueryType::kRoute:
+        return 16u;
+    default:
+        return 1u;
+    }
+}
+
+// Одинаковые запросы: тот же тип и те же аргументы, id не учитывается
+std::string MakeCommandKey(const StatCommand& command) {
+    std::string key(1u, static_cast<char>(command.query_type));
+    if (const std::string* name = std::get_if<std::string>(&command.data)) {
+        key += *name;
+    }
+    else if (const RouteCommand* route = std::get_if<RouteCommand>(&command.data)) {
+        key += route->from;
+        key += '\0';
+        key += route->to;
+    }
+    return key;
+}
+
+// План выполнения пакета: каждый различный запрос выполняется один раз
+struct BatchPlan {
+    // Номер первого такого же запроса в пакете (для первого вхождения - свой номер)
+    std::vector<size_t> source;
+    // Для первых вхождений: номер последнего запроса, которому нужен этот ответ
+    std::vector<size_t> last_use;
+    size_t duplicates = 0u;
+};
+
+BatchPlan PlanBatch(const std::vector<StatCommand>& commands) {
+    BatchPlan plan;
+    plan.source.resize(commands.size());
+    plan.last_use.resize(commands.size());
+
+    std::unordered_map<std::string, size_t> first_by_key;
+    first_by_key.reserve(commands.size());
+    for (size_t i = 0u; i < commands.size(); ++i) {
+        // Снимок метрик зависит от момента выполнения, такие запросы не объединяются
+        if (commands[i].query_type == QueryType::kMetrics) {
+            plan.source[i] = i;
+            plan.last_use[i] = i;
+            continue;
+        }
+        const auto [it, inserted] = first_by_key.emplace(MakeCommandKey(commands[i]), i);
+        plan.source[i] = it->second;
+        plan.last_use[it->second] = i;
+        if (!inserted) {
+            ++plan.duplicates;
+        }
+    }
+
+    return plan;
+}
+
+}  // namespace
+
+RequestHandler::RequestHandler(const tc::TransportCatalogue& db, const map_render::MapRender& renderer, const transport_router::TransportRouter& router,
+    thread_pool::ThreadPool* pool)
     : db_(db)
     , renderer_(renderer)
-    , router_(router) {
+    , router_(router)
+    , pool_(pool) {
 }
 
 std::vector<StatInfo> RequestHandler::GetStats(const std::vector<StatCommand>& commands) const {
+    const BatchPlan plan = PlanBatch(commands);
+    collapsed_count_ += plan.duplicates;
+    metrics::Add(metrics::Counter::kCollapsedRequests, plan.duplicates);
+
+    std::vector<size_t> distinct;
+    std::vector<size_t> position(commands.size());
+    for (size_t i = 0u; i < commands.size(); ++i) {
+        if (plan.source[i] == i) {
+            position[i] = distinct.size();
+            distinct.push_back(i);
+        }
+    }
+
+    std::vector<StatInfo> computed;
+    ComputeStats(commands, distinct, computed);
+
     std::vector<StatInfo> result;
     result.reserve(commands.size());
-    for (const auto& command : commands) {
-        result.push_back(std::move(GetStat(command)));
+    for (size_t i = 0u; i < commands.size(); ++i) {
+        StatInfo& stat = computed[position[plan.source[i]]];
+        // Последний получатель забирает ответ, остальные копируют
+        if (plan.last_use[plan.source[i]] == i) {
+            result.push_back(std::move(stat));
+        }
+        else {
+            result.push_back(stat);
+        }
+        result.back().id = commands[i].id;
     }
 
     return result;
 }
 
+void RequestHandler::ProcessStats(const std::vector<StatCommand>& commands, const StatSink& sink,
+    size_t window_size) const {
+    window_size = std::max<size_t>(window_size, 1u);
+    const BatchPlan plan = PlanBatch(commands);
+    collapsed_count_ += plan.duplicates;
+    metrics::Add(metrics::Counter::kCollapsedRequests, plan.duplicates);
+
+    // Ответы, которые понадобятся запросам из следующих окон
+    std::unordered_map<size_t, StatInfo> shared;
+    std::vector<size_t> distinct;
+    std::vector<StatInfo> window;
+
+    for (size_t begin = 0u; begin < commands.size(); begin += window_size) {
+        const size_t end = std::min(begin + window_size, commands.size());
+        distinct.clear();
+        for (size_t i = begin; i < end; ++i) {
+            if (plan.source[i] == i) {
+                distinct.push_back(i);
+            }
+        }
+        ComputeStats(commands, distinct, window);
+
+        auto computed = window.begin();
+        for (size_t i = begin; i < end; ++i) {
+            const size_t source = plan.source[i];
+            // Повторы получают тот же объект ответа, меняется только id
+            StatInfo& stat = source == i ? *computed++ : shared.at(source);
+            stat.id = commands[i].id;
+            sink(stat);
+
+            if (source == i && plan.last_use[i] > i) {
+                shared.emplace(i, std::move(stat));
+            }
+            else if (source != i && plan.last_use[source] == i) {
+                shared.erase(source);
+            }
+        }
+    }
+}
+
+void RequestHandler::PipelineStats(const std::vector<StatCommand>& commands, const StatSink& sink,
+    size_t executors_count) const {
+    const BatchPlan plan = PlanBatch(commands);
+    collapsed_count_ += plan.duplicates;
+    metrics::Add(metrics::Counter::kCollapsedRequests, plan.duplicates);
+
+    // Повторы не выполняются: их ответ берётся у первого вхождения при выводе
+    std::unordered_map<size_t, StatInfo> shared;
+    size_t next = 0u;
+    size_t emitted = 0u;
+
+    pipeline::Pipeline<size_t, std::optional<StatInfo>>(executors_count).Run(
+        [&](size_t& index) {
+            if (next == commands.size()) {
+                return false;
+            }
+            index = next++;
+            return true;
+        },
+        [&](size_t index) -> std::optional<StatInfo> {
+            if (plan.source[index] != index) {
+                return std::nullopt;
+            }
+            return GetStat(commands[index]);
+        },
+        [&](std::optional<StatInfo>& answer) {
+            const size_t i = emitted++;
+            const size_t source = plan.source[i];
+            StatInfo& stat = answer ? *answer : shared.at(source);
+            stat.id = commands[i].id;
+            sink(stat);
+
+            if (source == i && plan.last_use[i] > i) {
+                shared.emplace(i, std::move(stat));
+            }
+            else if (source != i && plan.last_use[source] == i) {
+                shared.erase(source);
+            }
+        });
+}
+
+size_t RequestHandler::GetCollapsedCount() const {
+    return collapsed_count_.load();
+}
+
 StatInfo RequestHandler::GetStat(const StatCommand& command) const {
+    metrics::ScopedTimer timer(metrics::GetRequestTimer(command.query_type));
     StatInfo result;
     result.id = command.id;
     result.query_type = command.query_type;
@@ -29,30 +214,129 @@ StatInfo RequestHandler::GetStat(const StatCommand& command) const {
     case reader::QueryType::kBus: {
         const tc::BusPtr bus = db_.GetBusByName(std::get<std::string>(command.data));
         if (bus) {
+            metrics::ScopedTimer stat_timer(metrics::Timer::kGetBusStat);
             result.info = db_.GetStat(bus);
         }
     } break;
-    case reader::QueryType::kMap: {
-        std::ostringstream out;
-        RenderMap().Render(out);
-        result.info = std::move(out.str());
-
-    } break;
+    case reader::QueryType::kMap:
+        result.info = GetRenderedMap();
+        break;
     case reader::QueryType::kRoute: {
         const auto& route_command=std::get<RouteCommand>(command.data);
-        std::optional<domain::TRouteStat> route_stat = router_.GetRoute(route_command.from, route_command.to);
+        metrics::Add(metrics::Counter::kRouteLookups);
+        std::optional<domain::TRouteStat> route_stat;
+        {
+            metrics::ScopedTimer route_timer(metrics::Timer::kGetRoute);
+            route_stat = router_.GetRoute(route_command.from, route_command.to);
+        }
         if (route_stat) {
             result.info = std::move(route_stat.value());
         }
+        else {
+            metrics::Add(metrics::Counter::kRoutesNotFound);
+        }
     } break;
+    case reader::QueryType::kMetrics:
+        result.info = metrics::GetSnapshot();
+        break;
 
     }
 
     return result;
 }
 
+void RequestHandler::ServeBinary(std::istream& input, std::ostream& output) const {
+    std::string request;
+    std::string response;
+    const auto send = [&output, &response] {
+        binary::WriteFrame(output, response);
+        metrics::Add(metrics::Counter::kBytesEmitted, sizeof(uint32_t) + response.size());
+        output.flush();
+    };
+
+    while (true) {
+        try {
+            if (!binary::ReadFrame(input, request)) {
+                return;
+            }
+        }
+        catch (const binary::ProtocolError& e) {
+            // После испорченного кадра граница следующего неизвестна:
+            // клиент получает ошибку без заголовка запроса, чтение прекращается
+            binary::EncodeError({}, e.what(), response);
+            send();
+            return;
+        }
+
+        try {
+            binary::EncodeResponse(GetStat(binary::DecodeRequest(request, db_)), db_, response);
+        }
+        catch (const std::exception& e) {
+            binary::EncodeError(request, e.what(), response);
+        }
+        send();
+    }
+}
+
+void RequestHandler::ComputeStats(const std::vector<StatCommand>& commands, const std::vector<size_t>& indices,
+    std::vector<StatInfo>& result) const {
+    result.clear();
+    result.resize(indices.size());
+
+    if (!pool_ || pool_->GetThreadsCount() == 1u) {
+        for (size_t k = 0u; k < indices.size(); ++k) {
+            result[k] = GetStat(commands[indices[k]]);
+        }
+        return;
+    }
+
+    // Порции режутся по оценке стоимости, а не по числу запросов: тяжёлый запрос
+    // оказывается в порции один, лёгкие собираются вместе
+    size_t total_cost = 0u;
+    for (const size_t i : indices) {
+        total_cost += EstimateCost(commands[i]);
+    }
+    const size_t chunk_cost = std::max<size_t>(total_cost / (pool_->GetThreadsCount() * kChunksPerThread), 1u);
+
+    std::vector<size_t> bounds{ 0u };
+    size_t cost = 0u;
+    for (size_t k = 0u; k < indices.size(); ++k) {
+        const size_t item_cost = EstimateCost(commands[indices[k]]);
+        if (cost > 0u && cost + item_cost > chunk_cost) {
+            bounds.push_back(k);
+            cost = 0u;
+        }
+        cost += item_cost;
+    }
+    bounds.push_back(indices.size());
+
+    // Каждый ответ пишется в свою ячейку, поэтому порядок не меняется
+    pool_->ForEach(bounds.size() - 1u, [&](size_t chunk) {
+        for (size_t k = bounds[chunk]; k < bounds[chunk + 1u]; ++k) {
+            result[k] = GetStat(commands[indices[k]]);
+        }
+    });
+}
+
 svg::Document RequestHandler::RenderMap() const {
+    metrics::ScopedTimer timer(metrics::Timer::kRenderMap);
     return renderer_.GetMapForTC(db_.GetStopsWithRoutes(), db_.GetBuses());
 }
 
+std::shared_ptr<const std::string> RequestHandler::GetRenderedMap() const {
+    // Параллельные запросы ждут первую отрисовку, а не рисуют карту каждый сам
+    std::lock_guard lock(map_mutex_);
+    if (!map_cache_ || map_version_ != db_.GetVersion()) {
+        std::string map;
+        RenderMap().Render(map, renderer_.GetNumberFormat());
+        map_cache_ = std::make_shared<const std::string>(std::move(map));
+        map_version_ = db_.GetVersion();
+        metrics::Add(metrics::Counter::kMapRenders);
+    }
+    else {
+        metrics::Add(metrics::Counter::kMapCacheHits);
+    }
+    return map_cache_;
+}
+
 }
\ No newline at end of file
@@ -1,12 +1,17 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <sstream>
 
 #include "transport_catalogue.h"
 #include "map_renderer.h"
 #include "transport_router.h"
+#include "thread_pool.h"
 
 namespace handler {
 
@@ -17,19 +22,52 @@ using namespace reader;
 
 class RequestHandler {
 public:
-    RequestHandler(const tc::TransportCatalogue& db, const map_render::MapRender& renderer, const transport_router::TransportRouter& router);
+    // Если передан pool, пакеты запросов в GetStats и ProcessStats выполняются параллельно
+    RequestHandler(const tc::TransportCatalogue& db, const map_render::MapRender& renderer, const transport_router::TransportRouter& router,
+        thread_pool::ThreadPool* pool = nullptr);
 
 public:
+    using StatSink = std::function<void(const StatInfo&)>;
+    static constexpr size_t kDefaultWindowSize = 64u;
+
+    // Одинаковые запросы пакета (тип и аргументы совпадают, id - нет) выполняются один раз
     std::vector<StatInfo> GetStats(const std::vector<StatCommand>& commands) const;
+    // Выполняет запросы окнами по window_size штук и сразу передаёт ответы в sink
+    // в исходном порядке. Кроме окна в памяти держатся только ответы, повторы
+    // которых ещё впереди.
+    void ProcessStats(const std::vector<StatCommand>& commands, const StatSink& sink,
+        size_t window_size = kDefaultWindowSize) const;
+    // То же, что ProcessStats, но конвейером (pipeline.h): подача запросов, их выполнение
+    // на executors_count потоках и передача ответов в sink идут одновременно
+    void PipelineStats(const std::vector<StatCommand>& commands, const StatSink& sink,
+        size_t executors_count = 0u) const;
+    // Сколько повторных запросов не выполнялось, а получило готовый ответ
+    size_t GetCollapsedCount() const;
     StatInfo GetStat(const StatCommand& command) const;
+    // Читает запросы в двоичном протоколе (binary_protocol.h) до конца потока
+    // и отвечает на каждый отдельным кадром, сбрасывая вывод. На обрезанный
+    // или слишком большой кадр отвечает ошибкой и прекращает чтение.
+    void ServeBinary(std::istream& input, std::ostream& output) const;
 
 private:
+    // Заполняет result[k] ответом на commands[indices[k]]
+    void ComputeStats(const std::vector<StatCommand>& commands, const std::vector<size_t>& indices,
+        std::vector<StatInfo>& result) const;
     svg::Document RenderMap() const;
+    // Отрисованная карта одинакова для всех запросов Map, пока справочник не изменился
+    std::shared_ptr<const std::string> GetRenderedMap() const;
 
 private:
     const tc::TransportCatalogue& db_;
     const map_render::MapRender& renderer_;
     const transport_router::TransportRouter& router_;
+    thread_pool::ThreadPool* pool_;
+
+    mutable std::mutex map_mutex_;
+    mutable std::shared_ptr<const std::string> map_cache_;
+    mutable uint64_t map_version_ = 0u;
+
+    mutable std::atomic<size_t> collapsed_count_{ 0u };
 };
 
 }
@@ -0,0 +1,420 @@
+#include "requests_decoder.h"
+
+#include "perfect_hash.h"
+
+namespace json_reader {
+using namespace std::literals;
+
+namespace {
+
+// Порядок ключей совпадает с RequestsDecoder::Field
+constexpr detail::PerfectHash<12> kFields({
+    "type"sv, "name"sv, "latitude"sv, "longitude"sv, "road_distances"sv, "stops"sv,
+    "is_roundtrip"sv, "id"sv, "from"sv, "to"sv, "base_requests"sv, "stat_requests"sv
+});
+
+// Порядок совпадает с reader::QueryType
+constexpr detail::PerfectHash<5> kQueryTypes({ "Stop"sv, "Bus"sv, "Map"sv, "Route"sv, "Metrics"sv });
+
+constexpr uint32_t Bit(size_t field) {
+    return 1u << field;
+}
+
+}  // namespace
+
+StatCommandError::StatCommandError(const std::string& message, std::optional<int> id)
+    : std::runtime_error(message)
+    , id_(id) {
+}
+
+std::optional<int> StatCommandError::GetId() const {
+    return id_;
+}
+
+RequestsDecoder::RequestsDecoder(std::pmr::memory_resource* resource)
+    : resource_(resource)
+    , settings_(resource) {
+}
+
+RequestsDecoder::Field RequestsDecoder::ToField(std::string_view key) {
+    return static_cast<Field>(kFields.Find(key));
+}
+
+// ---------- Events ------------------------------------------------------------
+
+void RequestsDecoder::Null() {
+    if (Bypass(0) || Capture(0, [](json::DomBuilder& builder) { builder.Null(); })) {
+        return;
+    }
+    if ((state_ == State::kBaseItem || state_ == State::kStatItem) && field_ == Field::kUnknown) {
+        return;
+    }
+    Unexpected();
+}
+
+void RequestsDecoder::Bool(bool value) {
+    if (Bypass(0) || Capture(0, [value](json::DomBuilder& builder) { builder.Bool(value); })) {
+        return;
+    }
+    if (state_ == State::kBaseItem && field_ == Field::kIsRoundtrip) {
+        is_roundtrip_ = value;
+        return;
+    }
+    if ((state_ == State::kBaseItem || state_ == State::kStatItem) && field_ == Field::kUnknown) {
+        return;
+    }
+    Unexpected();
+}
+
+void RequestsDecoder::Int(int value) {
+    if (Bypass(0) || Capture(0, [value](json::DomBuilder& builder) { builder.Int(value); })) {
+        return;
+    }
+    switch (state_) {
+    case State::kDistances:
+        distances_.push_back({ value, std::move(dest_) });
+        return;
+    case State::kStatItem:
+        if (field_ == Field::kId) {
+            id_ = value;
+            has_id_ = true;
+            return;
+        }
+        break;
+    case State::kBaseItem:
+        if (field_ == Field::kLatitude || field_ == Field::kLongitude) {
+            Double(value);
+            return;
+        }
+        break;
+    default:
+        break;
+    }
+    if ((state_ == State::kBaseItem || state_ == State::kStatItem) && field_ == Field::kUnknown) {
+        return;
+    }
+    Unexpected();
+}
+
+void RequestsDecoder::Double(double value) {
+    if (Bypass(0) || Capture(0, [value](json::DomBuilder& builder) { builder.Double(value); })) {
+        return;
+    }
+    if (state_ == State::kBaseItem) {
+        if (field_ == Field::kLatitude) {
+            latitude_ = value;
+            return;
+        }
+        if (field_ == Field::kLongitude) {
+            longitude_ = value;
+            return;
+        }
+    }
+    if ((state_ == State::kBaseItem || state_ == State::kStatItem) && field_ == Field::kUnknown) {
+        return;
+    }
+    Unexpected();
+}
+
+void RequestsDecoder::String(std::string_view value) {
+    if (Bypass(0) || Capture(0, [value](json::DomBuilder& builder) { builder.String(value); })) {
+        return;
+    }
+    switch (state_) {
+    case State::kBusStops:
+        stops_.emplace_back(value);
+        return;
+    case State::kBaseItem:
+    case State::kStatItem:
+        switch (field_) {
+        case Field::kType:
+            type_ = kQueryTypes.Find(value);
+            return;
+        case Field::kName:
+            name_ = value;
+            return;
+        case Field::kFrom:
+            from_ = value;
+            return;
+        case Field::kTo:
+            to_ = value;
+            return;
+        case Field::kUnknown:
+            return;
+        default:
+            break;
+        }
+        break;
+    default:
+        break;
+    }
+    Unexpected();
+}
+
+void RequestsDecoder::StartObject() {
+    if (Bypass(1) || Capture(1, [](json::DomBuilder& builder) { builder.StartObject(); })) {
+        return;
+    }
+    switch (state_) {
+    case State::kRoot:
+        if (single_stat_) {
+            BeginItem();
+            state_ = State::kStatItem;
+        }
+        else {
+            state_ = State::kRootKey;
+        }
+        return;
+    case State::kBaseArray:
+        BeginItem();
+        state_ = State::kBaseItem;
+        return;
+    case State::kStatArray:
+        BeginItem();
+        state_ = State::kStatItem;
+        return;
+    case State::kBaseItem:
+        if (field_ == Field::kRoadDistances) {
+            state_ = State::kDistances;
+            return;
+        }
+        break;
+    default:
+        break;
+    }
+    if ((state_ == State::kBaseItem || state_ == State::kStatItem) && field_ == Field::kUnknown) {
+        BeginSkip(1);
+        return;
+    }
+    Unexpected();
+}
+
+void RequestsDecoder::Key(std::string_view key) {
+    if (Bypass(0) || Capture(0, [key](json::DomBuilder& builder) { builder.Key(key); })) {
+        return;
+    }
+    switch (state_) {
+    case State::kRootKey:
+        root_field_ = ToField(key);
+        if (root_field_ != Field::kBaseRequests && root_field_ != Field::kStatRequests) {
+            root_field_ = Field::kUnknown;
+            capture_key_ = key;
+        }
+        state_ = State::kRootValue;
+        break;
+    case State::kBaseItem:
+    case State::kStatItem: {
+        field_ = ToField(key);
+        const bool known = state_ == State::kBaseItem
+            ? field_ <= Field::kIsRoundtrip
+            : field_ == Field::kType || field_ == Field::kName || field_ == Field::kId
+                || field_ == Field::kFrom || field_ == Field::kTo;
+        if (!known) {
+            // Чужие для этого вида запроса ключи пропускаются
+            field_ = Field::kUnknown;
+            break;
+        }
+        seen_ |= Bit(static_cast<size_t>(field_));
+    } break;
+    case State::kDistances:
+        dest_ = key;
+        break;
+    default:
+        Unexpected();
+    }
+}
+
+void RequestsDecoder::EndObject() {
+    if (Bypass(-1) || Capture(-1, [](json::DomBuilder& builder) { builder.EndObject(); })) {
+        return;
+    }
+    switch (state_) {
+    case State::kRootKey:
+        state_ = State::kDone;
+        break;
+    case State::kBaseItem:
+        FinishBaseItem();
+        state_ = State::kBaseArray;
+        break;
+    case State::kStatItem:
+        FinishStatItem();
+        state_ = single_stat_ ? State::kDone : State::kStatArray;
+        break;
+    case State::kDistances:
+        state_ = State::kBaseItem;
+        break;
+    default:
+        Unexpected();
+    }
+}
+
+void RequestsDecoder::StartArray() {
+    if (Bypass(1) || Capture(1, [](json::DomBuilder& builder) { builder.StartArray(); })) {
+        return;
+    }
+    if (state_ == State::kRootValue) {
+        state_ = root_field_ == Field::kBaseRequests ? State::kBaseArray : State::kStatArray;
+        return;
+    }
+    if (state_ == State::kBaseItem && field_ == Field::kStops) {
+        state_ = State::kBusStops;
+        return;
+    }
+    if ((state_ == State::kBaseItem || state_ == State::kStatItem) && field_ == Field::kUnknown) {
+        BeginSkip(1);
+        return;
+    }
+    Unexpected();
+}
+
+void RequestsDecoder::EndArray() {
+    if (Bypass(-1) || Capture(-1, [](json::DomBuilder& builder) { builder.EndArray(); })) {
+        return;
+    }
+    switch (state_) {
+    case State::kBaseArray:
+    case State::kStatArray:
+        state_ = State::kRootKey;
+        break;
+    case State::kBusStops:
+        state_ = State::kBaseItem;
+        break;
+    default:
+        Unexpected();
+    }
+}
+
+// ---------- Results ------------------------------------------------------------
+
+BaseRequests& RequestsDecoder::GetBaseRequests() {
+    return base_;
+}
+
+std::vector<reader::StatCommand>& RequestsDecoder::GetStatCommands() {
+    return stat_commands_;
+}
+
+json::Node RequestsDecoder::ExtractSettings() {
+    return json::Node(std::move(settings_));
+}
+
+reader::StatCommand RequestsDecoder::DecodeStatCommand(std::string_view input) {
+    RequestsDecoder decoder;
+    decoder.single_stat_ = true;
+    try {
+        json::Parse(input, decoder);
+    }
+    catch (const std::exception& e) {
+        throw StatCommandError(e.what(), decoder.has_id_ ? std::optional<int>(decoder.id_) : std::nullopt);
+    }
+    return std::move(decoder.stat_commands_.front());
+}
+
+// ---------- Helpers ------------------------------------------------------------
+
+bool RequestsDecoder::Bypass(int depth_change) {
+    if (skip_depth_ == 0) {
+        return false;
+    }
+    skip_depth_ += depth_change;
+    return true;
+}
+
+// Значение ключа корня, не описанного схемой, собирается в дерево целиком
+template <typename Emit>
+bool RequestsDecoder::Capture(int depth_change, Emit emit) {
+    if (capture_depth_ == 0) {
+        if (state_ != State::kRootValue || root_field_ != Field::kUnknown) {
+            return false;
+        }
+        capture_.emplace(resource_);
+        state_ = State::kRootKey;
+    }
+
+    emit(*capture_);
+    capture_depth_ += depth_change;
+    if (capture_depth_ == 0) {
+        if (!settings_.emplace(json::SmallString(capture_key_, resource_), capture_->Extract()).second) {
+            throw json::ParsingError("Duplicate key '"s + capture_key_ + "' have been found"s);
+        }
+        capture_.reset();
+    }
+    return true;
+}
+
+void RequestsDecoder::BeginSkip(int depth_change) {
+    skip_depth_ = depth_change;
+}
+
+void RequestsDecoder::BeginItem() {
+    field_ = Field::kUnknown;
+    seen_ = 0u;
+    type_ = kQueryTypes.kNotFound;
+    name_.clear();
+    latitude_ = 0.0;
+    longitude_ = 0.0;
+    is_roundtrip_ = false;
+    id_ = 0;
+    has_id_ = false;
+    from_.clear();
+    to_.clear();
+    distances_.clear();
+    stops_.clear();
+}
+
+void RequestsDecoder::FinishBaseItem() {
+    Require(Field::kType);
+    Require(Field::kName);
+    const auto type = static_cast<reader::QueryType>(type_);
+
+    if (type == reader::QueryType::kStop) {
+        Require(Field::kLatitude);
+        Require(Field::kLongitude);
+        StopRequest& request = base_.stops.emplace_back();
+        request.stop.name = std::move(name_);
+        request.stop.position = { latitude_, longitude_ };
+        request.distances = std::move(distances_);
+    }
+    else if (type == reader::QueryType::kBus) {
+        Require(Field::kIsRoundtrip);
+        Require(Field::kStops);
+        base_.buses.push_back({ std::move(name_), std::move(stops_), is_roundtrip_ });
+    }
+    else {
+        throw json::ParsingError("Unknown base request type"s);
+    }
+}
+
+void RequestsDecoder::FinishStatItem() {
+    Require(Field::kType);
+    Require(Field::kId);
+
+    reader::StatCommand& command = stat_commands_.emplace_back();
+    // Как и раньше, неизвестный тип запроса считается запросом остановки
+    command.query_type = type_ == kQueryTypes.kNotFound
+        ? reader::QueryType::kStop
+        : static_cast<reader::QueryType>(type_);
+    command.id = id_;
+
+    if (command.query_type == reader::QueryType::kRoute) {
+        Require(Field::kFrom);
+        Require(Field::kTo);
+        command.data = reader::RouteCommand{ std::move(from_), std::move(to_) };
+    }
+    else if (command.query_type != reader::QueryType::kMap && command.query_type != reader::QueryType::kMetrics) {
+        Require(Field::kName);
+        command.data = std::move(name_);
+    }
+}
+
+void RequestsDecoder::Require(Field field) const {
+    if (!(seen_ & Bit(static_cast<size_t>(field)))) {
+        throw std::out_of_range("Key '"s + std::string(kFields.GetKey(static_cast<size_t>(field))) + "' is not found"s);
+    }
+}
+
+void RequestsDecoder::Unexpected() const {
+    throw json::ParsingError("Unexpected value in requests document"s);
+}
+
+}
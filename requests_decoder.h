@@ -0,0 +1,161 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "domain.h"
+#include "json.h"
+
+namespace json_reader {
+
+struct DistanceSpec {
+    int distance_meters;
+    std::string dest;
+};
+
+struct StopRequest {
+    domain::Stop stop;
+    std::vector<DistanceSpec> distances;
+};
+
+// Остановки указаны именами: они могут быть описаны позже автобуса
+struct BusRequest {
+    std::string name;
+    std::vector<std::string> stops;
+    bool is_roundtrip = false;
+};
+
+struct BaseRequests {
+    std::vector<StopRequest> stops;
+    std::vector<BusRequest> buses;
+};
+
+// Ошибка разбора одиночного stat-запроса. Номер запроса известен,
+// если его значение успело разобраться до ошибки.
+class StatCommandError : public std::runtime_error {
+public:
+    StatCommandError(const std::string& message, std::optional<int> id);
+
+public:
+    std::optional<int> GetId() const;
+
+private:
+    std::optional<int> id_;
+};
+
+// Разбирает документ запросов по известной схеме прямо из событий парсера.
+// base_requests и stat_requests заполняют доменные структуры без промежуточных
+// Node, неизвестные ключи запросов пропускаются на месте. Остальные ключи корня
+// (render_settings, routing_settings...) невелики и сохраняются деревом.
+class RequestsDecoder final : public json::EventHandler {
+public:
+    explicit RequestsDecoder(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+public:
+    void Null() override;
+    void Bool(bool value) override;
+    void Int(int value) override;
+    void Double(double value) override;
+    void String(std::string_view value) override;
+    void StartObject() override;
+    void Key(std::string_view key) override;
+    void EndObject() override;
+    void StartArray() override;
+    void EndArray() override;
+
+    BaseRequests& GetBaseRequests();
+    std::vector<reader::StatCommand>& GetStatCommands();
+    // Корневой словарь без base_requests и stat_requests
+    json::Node ExtractSettings();
+
+    // Разбирает одиночный stat-запрос, например строку JSON Lines.
+    // Любая ошибка разбора выбрасывается как StatCommandError.
+    static reader::StatCommand DecodeStatCommand(std::string_view input);
+
+private:
+    enum class State {
+        kRoot,
+        kRootKey,
+        kRootValue,
+        kBaseArray,
+        kBaseItem,
+        kDistances,
+        kBusStops,
+        kStatArray,
+        kStatItem,
+        kDone
+    };
+
+    // Номера совпадают с порядком ключей в таблице в requests_decoder.cpp
+    enum class Field : uint8_t {
+        kType,
+        kName,
+        kLatitude,
+        kLongitude,
+        kRoadDistances,
+        kStops,
+        kIsRoundtrip,
+        kId,
+        kFrom,
+        kTo,
+        kBaseRequests,
+        kStatRequests,
+        kUnknown
+    };
+
+    static Field ToField(std::string_view key);
+
+    // Возвращает true, если событие поглощено пропуском или захватом поддерева
+    bool Bypass(int depth_change);
+    template <typename Emit>
+    bool Capture(int depth_change, Emit emit);
+    void BeginSkip(int depth_change);
+    void BeginItem();
+    void FinishBaseItem();
+    void FinishStatItem();
+    void Require(Field field) const;
+    [[noreturn]] void Unexpected() const;
+
+private:
+    std::pmr::memory_resource* resource_;
+    State state_ = State::kRoot;
+    bool single_stat_ = false;
+
+    // Пропуск значения неизвестного ключа: глубина вложенности пропускаемого поддерева
+    int skip_depth_ = 0;
+    // Захват значения ключа корня в дерево
+    std::optional<json::DomBuilder> capture_;
+    int capture_depth_ = 0;
+    std::string capture_key_;
+    json::Dict settings_;
+
+    Field root_field_ = Field::kUnknown;
+    Field field_ = Field::kUnknown;
+    uint32_t seen_ = 0u;
+
+    // Поля текущего запроса: тип может встретиться после остальных ключей,
+    // поэтому значения копятся до конца объекта. type_ - номер в таблице типов запросов
+    size_t type_ = 0u;
+    std::string name_;
+    double latitude_ = 0.0;
+    double longitude_ = 0.0;
+    bool is_roundtrip_ = false;
+    int id_ = 0;
+    bool has_id_ = false;
+    std::string from_;
+    std::string to_;
+    std::string dest_;
+    std::vector<DistanceSpec> distances_;
+    std::vector<std::string> stops_;
+
+    BaseRequests base_;
+    std::vector<reader::StatCommand> stat_commands_;
+};
+
+}
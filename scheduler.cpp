@@ -0,0 +1,135 @@
+#include "scheduler.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace scheduler {
+
+CostClass GetCostClass(reader::QueryType type) {
+    switch (type) {
+    case reader::QueryType::kMap:
+        return CostClass::kMap;
+    case reader::QueryType::kRoute:
+        return CostClass::kRoute;
+    default:
+        return CostClass::kLight;
+    }
+}
+
+Limits GetDefaultLimits(size_t workers_count) {
+    const size_t count = workers_count ? workers_count : std::max(1u, std::thread::hardware_concurrency());
+    Limits limits{};
+    limits[static_cast<size_t>(CostClass::kRoute)] = std::max<size_t>(count / 2u, 1u);
+    limits[static_cast<size_t>(CostClass::kMap)] = std::max<size_t>(count / 4u, 1u);
+    return limits;
+}
+
+PriorityScheduler::PriorityScheduler(size_t workers_count, Limits limits)
+    : limits_(limits) {
+    const size_t count = workers_count ? workers_count : std::max(1u, std::thread::hardware_concurrency());
+    workers_.reserve(count);
+    for (size_t i = 0u; i < count; ++i) {
+        workers_.emplace_back([this] {
+            WorkerLoop();
+        });
+    }
+}
+
+PriorityScheduler::~PriorityScheduler() {
+    Close();
+}
+
+void PriorityScheduler::Submit(CostClass cost_class, Job job) {
+    {
+        std::lock_guard lock(mutex_);
+        queues_[static_cast<size_t>(cost_class)].push_back(std::move(job));
+    }
+    ready_.notify_one();
+}
+
+void PriorityScheduler::Close() {
+    {
+        std::lock_guard lock(mutex_);
+        closed_ = true;
+    }
+    ready_.notify_all();
+    for (std::thread& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+void PriorityScheduler::WorkerLoop() {
+    std::unique_lock lock(mutex_);
+    while (true) {
+        std::optional<size_t> cost_class;
+        ready_.wait(lock, [this, &cost_class] {
+            cost_class = SelectClass();
+            return cost_class || (closed_ && IsDrained());
+        });
+        if (!cost_class) {
+            return;
+        }
+
+        const size_t index = *cost_class;
+        Job job = std::move(queues_[index].front());
+        queues_[index].pop_front();
+        ++running_[index];
+
+        lock.unlock();
+        job();
+        job = nullptr;
+        lock.lock();
+
+        --running_[index];
+        // Освободилось место в ограниченном классе: его очередь может ждать другой поток
+        if (closed_ && IsDrained()) {
+            ready_.notify_all();
+        }
+        else if (limits_[index] != 0u && !queues_[index].empty()) {
+            ready_.notify_one();
+        }
+    }
+}
+
+bool PriorityScheduler::IsRunnable(size_t cost_class) const {
+    return !queues_[cost_class].empty()
+        && (limits_[cost_class] == 0u || running_[cost_class] < limits_[cost_class]);
+}
+
+std::optional<size_t> PriorityScheduler::SelectClass() {
+    std::optional<size_t> selected;
+    for (size_t i = 0u; i < kCostClassesCount; ++i) {
+        if (!IsRunnable(i)) {
+            continue;
+        }
+        if (!selected) {
+            selected = i;
+        }
+        else if (bypassed_[i] >= kMaxBypasses && bypassed_[i] > bypassed_[*selected]) {
+            selected = i;
+        }
+    }
+    if (!selected) {
+        return std::nullopt;
+    }
+
+    for (size_t i = 0u; i < kCostClassesCount; ++i) {
+        if (i == *selected) {
+            bypassed_[i] = 0u;
+        }
+        else if (IsRunnable(i)) {
+            ++bypassed_[i];
+        }
+    }
+    return selected;
+}
+
+bool PriorityScheduler::IsDrained() const {
+    return std::all_of(queues_.begin(), queues_.end(), [](const std::deque<Job>& queue) {
+        return queue.empty();
+    });
+}
+
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "domain.h"
+
+namespace scheduler {
+
+// Классы стоимости запросов в порядке убывания приоритета
+enum class CostClass {
+    kLight,  // Stop, Bus, Metrics: поиск по имени за микросекунды
+    kRoute,  // первый запрос строит таблицу маршрутов, остальные ждут его
+    kMap,    // сериализация всей карты
+    kCount
+};
+
+inline constexpr size_t kCostClassesCount = static_cast<size_t>(CostClass::kCount);
+
+CostClass GetCostClass(reader::QueryType type);
+
+// Сколько заданий каждого класса может выполняться одновременно, 0 - без ограничения
+using Limits = std::array<size_t, kCostClassesCount>;
+
+// Лёгкие запросы без ограничения, маршруты - не больше половины потоков,
+// карта - не больше четверти (но хотя бы один поток).
+// workers_count = 0 означает число аппаратных потоков.
+Limits GetDefaultLimits(size_t workers_count);
+
+// Потоки, выполняющие задания по классам стоимости. У каждого класса своя очередь;
+// свободный поток берёт задание из самого приоритетного класса, не исчерпавшего
+// своё ограничение. Так дешёвые запросы не ждут за картой и маршрутами, а тяжёлые
+// занимают не больше заданного числа потоков. Чтобы поток тяжёлых заданий не
+// останавливался совсем, класс, пропущенный kMaxBypasses раз подряд, выбирается вне очереди.
+class PriorityScheduler {
+public:
+    using Job = std::function<void()>;
+
+    // workers_count = 0 означает число аппаратных потоков
+    PriorityScheduler(size_t workers_count, Limits limits);
+    PriorityScheduler(const PriorityScheduler&) = delete;
+    PriorityScheduler& operator=(const PriorityScheduler&) = delete;
+    ~PriorityScheduler();
+
+public:
+    // Задание не должно выбрасывать исключений
+    void Submit(CostClass cost_class, Job job);
+    // Выполняет уже поставленные задания и останавливает потоки
+    void Close();
+
+private:
+    static constexpr size_t kMaxBypasses = 32u;
+
+    void WorkerLoop();
+    bool IsRunnable(size_t cost_class) const;
+    // Выбирает класс следующего задания. Вызывается под mutex_.
+    std::optional<size_t> SelectClass();
+    bool IsDrained() const;
+
+private:
+    Limits limits_;
+    std::array<std::deque<Job>, kCostClassesCount> queues_;
+    std::array<size_t, kCostClassesCount> running_{};
+    std::array<size_t, kCostClassesCount> bypassed_{};
+
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    bool closed_ = false;
+
+    std::vector<std::thread> workers_;
+};
+
+}
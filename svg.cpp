@@ -1,24 +1,100 @@
 #include "svg.h"
 
+#include <algorithm>
+#include <charconv>
+#include <sstream>
+
 namespace svg {
 
 using namespace std::literals;
 
+namespace {
+
+bool IsSameColor(const Color& lhs, const Color& rhs) {
+    if (lhs.index() != rhs.index()) {
+        return false;
+    }
+    if (const std::string* name = std::get_if<std::string>(&lhs)) {
+        return *name == std::get<std::string>(rhs);
+    }
+    if (const Rgba* rgba = std::get_if<Rgba>(&lhs)) {
+        const Rgba& other = std::get<Rgba>(rhs);
+        return rgba->red == other.red && rgba->green == other.green && rgba->blue == other.blue
+            && rgba->opacity == other.opacity;
+    }
+    if (const Rgb* rgb = std::get_if<Rgb>(&lhs)) {
+        const Rgb& other = std::get<Rgb>(rhs);
+        return rgb->red == other.red && rgb->green == other.green && rgb->blue == other.blue;
+    }
+    return true;
+}
+
+bool IsSameColor(const std::optional<Color>& lhs, const std::optional<Color>& rhs) {
+    return lhs.has_value() == rhs.has_value() && (!lhs || IsSameColor(*lhs, *rhs));
+}
+
+void CombineHash(size_t& hash, size_t value) {
+    hash = hash * 37u + value;
+}
+
+size_t HashColor(const std::optional<Color>& color) {
+    if (!color) {
+        return 0u;
+    }
+    size_t hash = color->index() + 1u;
+    if (const std::string* name = std::get_if<std::string>(&*color)) {
+        CombineHash(hash, std::hash<std::string>{}(*name));
+    }
+    else if (const Rgba* rgba = std::get_if<Rgba>(&*color)) {
+        CombineHash(hash, (rgba->red << 16u) | (rgba->green << 8u) | rgba->blue);
+        CombineHash(hash, std::hash<double>{}(rgba->opacity));
+    }
+    else if (const Rgb* rgb = std::get_if<Rgb>(&*color)) {
+        CombineHash(hash, (rgb->red << 16u) | (rgb->green << 8u) | rgb->blue);
+    }
+    return hash;
+}
+
+std::string_view ToString(StrokeLineCap stroke_linecap) {
+    switch (stroke_linecap) {
+    case StrokeLineCap::BUTT: return "butt"sv;
+    case StrokeLineCap::ROUND: return "round"sv;
+    case StrokeLineCap::SQUARE: return "square"sv;
+    }
+    return {};
+}
+
+std::string_view ToString(StrokeLineJoin stroke_linejoin) {
+    switch (stroke_linejoin) {
+    case StrokeLineJoin::ARCS: return "arcs"sv;
+    case StrokeLineJoin::BEVEL: return "bevel"sv;
+    case StrokeLineJoin::MITER: return "miter"sv;
+    case StrokeLineJoin::MITER_CLIP: return "miter-clip"sv;
+    case StrokeLineJoin::ROUND: return "round"sv;
+    }
+    return {};
+}
+
+// Для чисел формата std::to_chars хватает 32 символов при разумном числе знаков
+constexpr int kMaxDecimals = 17;
+
+}  // namespace
+
 // ---------- Color ------------------
 
-void OstreamColorPrinter::operator()(std::string color) {
+void OstreamColorPrinter::operator()(const std::string& color) {
     out << color;
 }
 void OstreamColorPrinter::operator()(const Rgb& rgb) {
-    out << "rgb("s << static_cast<int>(rgb.red)
-        << ","s << static_cast<int>(rgb.green)
-        << ","s << static_cast<int>(rgb.blue) << ")"s;
+    out << "rgb("sv << static_cast<int>(rgb.red)
+        << ","sv << static_cast<int>(rgb.green)
+        << ","sv << static_cast<int>(rgb.blue) << ")"sv;
 }
 void OstreamColorPrinter::operator()(const Rgba& rgba) {
-    out << "rgba("s << static_cast<int>(rgba.red)
-        << ","s << static_cast<int>(rgba.green)
-        << ","s << static_cast<int>(rgba.blue)
-        << ","s << rgba.opacity << ")"s;
+    out << "rgba("sv << static_cast<int>(rgba.red)
+        << ","sv << static_cast<int>(rgba.green)
+        << ","sv << static_cast<int>(rgba.blue)
+        << ","sv << rgba.opacity << ")"sv;
 }
 
 std::ostream& operator<< (std::ostream& out, const Color& color) {
@@ -54,32 +130,162 @@ void Object::Render(const RenderContext& context) const {
     context.out << std::endl;
 }
 
+// ---------- ObjectContainer ------------------
+
+void ObjectContainer::AddObject(Circle&& circle) {
+    AddPtr(std::make_unique<Circle>(std::move(circle)));
+}
+
+void ObjectContainer::AddObject(Polyline&& polyline) {
+    AddPtr(std::make_unique<Polyline>(std::move(polyline)));
+}
+
+void ObjectContainer::AddObject(Text&& text) {
+    AddPtr(std::make_unique<Text>(std::move(text)));
+}
+
 // ---------- StrokeLineCap ------------------
 
 std::ostream& operator<< (std::ostream& out, StrokeLineCap stroke_linecap) {
-    using namespace std::literals;
-    switch (stroke_linecap) {
-    case svg::StrokeLineCap::BUTT: return out << "butt"sv;
-    case svg::StrokeLineCap::ROUND: return out << "round"sv;
-    case svg::StrokeLineCap::SQUARE: return out << "square"sv;
-    }
-
-    return out;
+    return out << ToString(stroke_linecap);
 }
 
 // ---------- StrokeLineJoin ------------------
 
 std::ostream& operator<< (std::ostream& out, StrokeLineJoin stroke_linejoin) {
-    using namespace std::literals;
-    switch (stroke_linejoin) {
-    case svg::StrokeLineJoin::ARCS: return out << "arcs"s;
-    case svg::StrokeLineJoin::BEVEL: return out << "bevel"s;
-    case svg::StrokeLineJoin::MITER: return out << "miter"s;
-    case svg::StrokeLineJoin::MITER_CLIP: return out << "miter-clip"s;
-    case svg::StrokeLineJoin::ROUND: return out << "round"s;
+    return out << ToString(stroke_linejoin);
+}
+
+// ---------- OutputBuffer ------------------
+
+OutputBuffer::OutputBuffer(std::string& output, NumberFormat format)
+    : output_(output)
+    , format_(format) {
+}
+
+OutputBuffer& OutputBuffer::operator<<(uint32_t value) {
+    char buffer[16];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    output_.append(buffer, result.ptr);
+    return *this;
+}
+
+OutputBuffer& OutputBuffer::operator<<(double value) {
+    if (!format_.decimals) {
+        WriteGeneral(value);
+        return *this;
     }
 
-    return out;
+    char buffer[64];
+    const int decimals = std::clamp(*format_.decimals, 0, kMaxDecimals);
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::fixed, decimals);
+    if (result.ec != std::errc()) {
+        // Очень большие числа не помещаются в fixed-запись
+        WriteGeneral(value);
+        return *this;
+    }
+
+    // Завершающие нули и точка не несут информации: 12.50 -> 12.5, 3.00 -> 3
+    char* end = result.ptr;
+    if (decimals > 0) {
+        while (end[-1] == '0') {
+            --end;
+        }
+        if (end[-1] == '.') {
+            --end;
+        }
+    }
+    // -0.001 при двух знаках округляется до -0
+    if (end - buffer == 2 && buffer[0] == '-' && buffer[1] == '0') {
+        output_.push_back('0');
+    }
+    else {
+        output_.append(buffer, end);
+    }
+    return *this;
+}
+
+OutputBuffer& OutputBuffer::operator<<(const Color& color) {
+    if (const std::string* name = std::get_if<std::string>(&color)) {
+        output_.append(*name);
+    }
+    else if (const Rgba* rgba = std::get_if<Rgba>(&color)) {
+        *this << "rgba("sv << uint32_t{ rgba->red } << ',' << uint32_t{ rgba->green } << ',' << uint32_t{ rgba->blue } << ',';
+        // Прозрачность не координата: выводится как в std::ostream
+        WriteGeneral(rgba->opacity);
+        output_.push_back(')');
+    }
+    else if (const Rgb* rgb = std::get_if<Rgb>(&color)) {
+        *this << "rgb("sv << uint32_t{ rgb->red } << ',' << uint32_t{ rgb->green } << ',' << uint32_t{ rgb->blue } << ')';
+    }
+    return *this;
+}
+
+OutputBuffer& OutputBuffer::operator<<(StrokeLineCap stroke_linecap) {
+    return *this << ToString(stroke_linecap);
+}
+
+OutputBuffer& OutputBuffer::operator<<(StrokeLineJoin stroke_linejoin) {
+    return *this << ToString(stroke_linejoin);
+}
+
+const NumberFormat& OutputBuffer::GetFormat() const {
+    return format_;
+}
+
+std::string& OutputBuffer::GetOutput() {
+    return output_;
+}
+
+void OutputBuffer::WriteGeneral(double value) {
+    char buffer[64];
+    const int precision = std::clamp(format_.precision, 0, kMaxDecimals);
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::general, precision);
+    output_.append(buffer, result.ptr);
+}
+
+// ---------- PathStyle ------------------
+
+void PathStyle::Render(std::ostream& out) const {
+    std::string text;
+    OutputBuffer buffer(text, { std::nullopt, static_cast<int>(out.precision()) });
+    Render(buffer);
+    out << text;
+}
+
+void PathStyle::Render(OutputBuffer& out) const {
+    if (fill_color) {
+        out << " fill=\""sv << *fill_color << '"';
+    }
+    if (stroke_color) {
+        out << " stroke=\""sv << *stroke_color << '"';
+    }
+    if (stroke_width) {
+        out << " stroke-width=\""sv << *stroke_width << '"';
+    }
+    if (stroke_linecap) {
+        out << " stroke-linecap=\""sv << *stroke_linecap << '"';
+    }
+    if (stroke_linejoin) {
+        out << " stroke-linejoin=\""sv << *stroke_linejoin << '"';
+    }
+}
+
+bool operator==(const PathStyle& lhs, const PathStyle& rhs) {
+    return IsSameColor(lhs.fill_color, rhs.fill_color)
+        && IsSameColor(lhs.stroke_color, rhs.stroke_color)
+        && lhs.stroke_width == rhs.stroke_width
+        && lhs.stroke_linecap == rhs.stroke_linecap
+        && lhs.stroke_linejoin == rhs.stroke_linejoin;
+}
+
+size_t PathStyleHasher::operator()(const PathStyle& style) const {
+    size_t hash = HashColor(style.fill_color);
+    CombineHash(hash, HashColor(style.stroke_color));
+    CombineHash(hash, style.stroke_width ? std::hash<double>{}(*style.stroke_width) : 0u);
+    CombineHash(hash, style.stroke_linecap ? static_cast<size_t>(*style.stroke_linecap) + 1u : 0u);
+    CombineHash(hash, style.stroke_linejoin ? static_cast<size_t>(*style.stroke_linejoin) + 1u : 0u);
+    return hash;
 }
 
 // ---------- Circle ------------------
@@ -96,10 +302,10 @@ Circle& Circle::SetRadius(double radius) {
 
 void Circle::RenderObject(const RenderContext& context) const {
     auto& out = context.out;
-    out << "<circle cx=\""s << center_.x << "\" cy=\""s << center_.y << "\" "s;
-    out << "r=\""s << radius_ << "\""s;
+    out << "<circle cx=\""sv << center_.x << "\" cy=\""sv << center_.y << "\" "sv;
+    out << "r=\""sv << radius_ << "\""sv;
     RenderAttrs(out);
-    out << "/>"s;
+    out << "/>"sv;
 }
 
 // ---------- Polyline ------------------
@@ -111,20 +317,20 @@ Polyline& Polyline::AddPoint(const Point& point) {
 
 void Polyline::RenderObject(const RenderContext& context) const {
     auto& out = context.out;
-    out << "<polyline points=\""s;
+    out << "<polyline points=\""sv;
     bool first = true;
     for (const Point& point : points_) {
         if (first) {
             first = false;
         }
         else {
-            out << " "s;
+            out << " "sv;
         }
-        out << point.x << ","s << point.y;
+        out << point.x << ","sv << point.y;
     }
     out << "\"";
     RenderAttrs(out);
-    out << "/>"s;
+    out << "/>"sv;
 }
 
 // ---------- Text ------------------
@@ -160,40 +366,58 @@ Text& Text::SetData(const std::string& data) {
 }
 
 void HtmlEncodeString(std::ostream& out, std::string_view sv) {
-    const std::map<char, std::string> escapes = {
-        {'&', "&amp;"s},
-        {'\"', "&quot;"s},
-        {'\'', "&apos;"s},
-        {'<', "&lt;"s},
-        {'>', "&gt;"s}
-    };
+    std::string text;
+    HtmlEncodeString(text, sv);
+    out << text;
+}
 
-    for (char c : sv) {
-        if (escapes.count(c)) {
-            out << escapes.at(c);
-        }
-        else {
-            out << c;
+// Участки без специальных символов копируются целиком
+void HtmlEncodeString(std::string& out, std::string_view sv) {
+    size_t begin = 0u;
+    for (size_t i = 0u; i < sv.size(); ++i) {
+        std::string_view escaped;
+        switch (sv[i]) {
+        case '&':
+            escaped = "&amp;"sv;
+            break;
+        case '"':
+            escaped = "&quot;"sv;
+            break;
+        case '\'':
+            escaped = "&apos;"sv;
+            break;
+        case '<':
+            escaped = "&lt;"sv;
+            break;
+        case '>':
+            escaped = "&gt;"sv;
+            break;
+        default:
+            continue;
         }
+        out.append(sv.substr(begin, i - begin));
+        out.append(escaped);
+        begin = i + 1u;
     }
+    out.append(sv.substr(begin));
 }
 
 void Text::RenderObject(const RenderContext& context) const {
     auto& out = context.out;
-    out << "<text"s;
+    out << "<text"sv;
     RenderAttrs(out);
-    out << " x=\""s << pos_.x << "\" y=\""s << pos_.y << "\" dx=\""s << offset_.x << "\" "s <<
-        "dy=\""s << offset_.y << "\" font-size=\""s << size_ << "\""s;
+    out << " x=\""sv << pos_.x << "\" y=\""sv << pos_.y << "\" dx=\""sv << offset_.x << "\" "sv <<
+        "dy=\""sv << offset_.y << "\" font-size=\""sv << size_ << "\""sv;
     if (!font_family_.empty()) {
-        out << " font-family=\"" << font_family_ << "\""s;
+        out << " font-family=\"" << font_family_ << "\""sv;
     }
     if (!font_weight_.empty()) {
-        out << " font-weight=\""s << font_weight_ << "\""s;
+        out << " font-weight=\""sv << font_weight_ << "\""sv;
     }
 
-    out << ">"s;
+    out << ">"sv;
     HtmlEncodeString(out, data_);
-    out << "</text>"s;
+    out << "</text>"sv;
 
 
 }
@@ -202,17 +426,165 @@ void Text::RenderObject(const RenderContext& context) const {
 
 void Document::AddPtr(std::unique_ptr<Object>&& obj) {
     objects_.push_back(std::move(obj));
+    AddRun(Kind::kObject);
+}
+
+void Document::AddObject(Circle&& circle) {
+    circles_.push_back({ circle.center_, circle.radius_, InternStyle(std::move(circle.style_)) });
+    AddRun(Kind::kCircle);
+}
+
+void Document::AddObject(Polyline&& polyline) {
+    PolylineRecord record;
+    record.first_point = static_cast<uint32_t>(points_.size());
+    record.points_count = static_cast<uint32_t>(polyline.points_.size());
+    record.style = InternStyle(std::move(polyline.style_));
+    points_.insert(points_.end(), polyline.points_.begin(), polyline.points_.end());
+    polylines_.push_back(record);
+    AddRun(Kind::kPolyline);
+}
+
+void Document::AddObject(Text&& text) {
+    TextRecord record;
+    record.pos = text.pos_;
+    record.offset = text.offset_;
+    record.size = text.size_;
+    record.style = InternStyle(std::move(text.style_));
+    record.font_family = InternString(std::move(text.font_family_));
+    record.font_weight = InternString(std::move(text.font_weight_));
+    record.data_begin = static_cast<uint32_t>(text_data_.size());
+    HtmlEncodeString(text_data_, text.data_);
+    record.data_size = static_cast<uint32_t>(text_data_.size() - record.data_begin);
+    texts_.push_back(record);
+    AddRun(Kind::kText);
+}
+
+void Document::AddRun(Kind kind) {
+    if (!runs_.empty() && runs_.back().kind == kind) {
+        ++runs_.back().count;
+    }
+    else {
+        runs_.push_back({ kind, 1u });
+    }
+}
+
+uint32_t Document::InternStyle(PathStyle&& style) {
+    const auto it = style_ids_.find(style);
+    if (it != style_ids_.end()) {
+        return it->second;
+    }
+    const auto id = static_cast<uint32_t>(styles_.size());
+    styles_.push_back(style);
+    style_ids_.emplace(std::move(style), id);
+    return id;
+}
+
+uint32_t Document::InternString(std::string&& value) {
+    const auto it = string_ids_.find(value);
+    if (it != string_ids_.end()) {
+        return it->second;
+    }
+    const auto id = static_cast<uint32_t>(strings_.size());
+    strings_.push_back(value);
+    string_ids_.emplace(std::move(value), id);
+    return id;
+}
+
+void Document::RenderCircle(OutputBuffer& out, const CircleRecord& circle, std::string_view style) const {
+    out << "<circle cx=\""sv << circle.center.x << "\" cy=\""sv << circle.center.y
+        << "\" r=\""sv << circle.radius << '"' << style << "/>"sv;
+}
+
+void Document::RenderPolyline(OutputBuffer& out, const PolylineRecord& polyline, std::string_view style) const {
+    out << "<polyline points=\""sv;
+    const Point* points = points_.data() + polyline.first_point;
+    for (uint32_t i = 0u; i < polyline.points_count; ++i) {
+        if (i > 0u) {
+            out << ' ';
+        }
+        out << points[i].x << ',' << points[i].y;
+    }
+    out << '"' << style << "/>"sv;
+}
+
+void Document::RenderText(OutputBuffer& out, const TextRecord& text, std::string_view style) const {
+    out << "<text"sv << style
+        << " x=\""sv << text.pos.x << "\" y=\""sv << text.pos.y
+        << "\" dx=\""sv << text.offset.x << "\" dy=\""sv << text.offset.y
+        << "\" font-size=\""sv << text.size << '"';
+    if (const std::string& font_family = strings_[text.font_family]; !font_family.empty()) {
+        out << " font-family=\""sv << font_family << '"';
+    }
+    if (const std::string& font_weight = strings_[text.font_weight]; !font_weight.empty()) {
+        out << " font-weight=\""sv << font_weight << '"';
+    }
+    out << '>' << std::string_view(text_data_).substr(text.data_begin, text.data_size) << "</text>"sv;
 }
 
 void Document::Render(std::ostream& out) const {
-    using namespace std::literals;
-    out << "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>"s << std::endl;
-    out << "<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\">"s << std::endl;
-    for (const auto& object : objects_) {
-        out << "  "s;
-        object->Render(out);
-    }
-    out << "</svg>"s;
+    std::string text;
+    Render(text, { std::nullopt, static_cast<int>(out.precision()) });
+    out << text;
+}
+
+void Document::Render(std::string& output, NumberFormat format) const {
+    // Грубая оценка размера, чтобы буфер не перевыделялся много раз
+    output.reserve(output.size() + 128u + (circles_.size() + polylines_.size()) * 64u + texts_.size() * 160u
+        + points_.size() * 16u + text_data_.size());
+    OutputBuffer out(output, format);
+
+    out << "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n"sv;
+    out << "<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\">\n"sv;
+
+    // Каждый стиль форматируется один раз: атрибуты записываются подряд в styles,
+    // style_ends[i] - конец i-го стиля
+    std::string styles;
+    std::vector<size_t> style_ends;
+    style_ends.reserve(styles_.size());
+    OutputBuffer style_out(styles, format);
+    for (const PathStyle& style : styles_) {
+        style.Render(style_out);
+        style_ends.push_back(styles.size());
+    }
+    const auto get_style = [&styles, &style_ends](uint32_t id) {
+        const size_t begin = id == 0u ? 0u : style_ends[id - 1u];
+        return std::string_view(styles).substr(begin, style_ends[id] - begin);
+    };
+
+    size_t circle = 0u;
+    size_t polyline = 0u;
+    size_t text = 0u;
+    size_t object = 0u;
+    for (const Run& run : runs_) {
+        for (uint32_t i = 0u; i < run.count; ++i) {
+            out << "  "sv;
+            switch (run.kind) {
+            case Kind::kCircle: {
+                const CircleRecord& record = circles_[circle++];
+                RenderCircle(out, record, get_style(record.style));
+                out << '\n';
+            } break;
+            case Kind::kPolyline: {
+                const PolylineRecord& record = polylines_[polyline++];
+                RenderPolyline(out, record, get_style(record.style));
+                out << '\n';
+            } break;
+            case Kind::kText: {
+                const TextRecord& record = texts_[text++];
+                RenderText(out, record, get_style(record.style));
+                out << '\n';
+            } break;
+            case Kind::kObject: {
+                // Объекты, добавленные через AddPtr, выводят себя в поток
+                std::ostringstream stream;
+                stream.precision(format.precision);
+                objects_[object++]->Render(stream);
+                out << std::move(stream).str();
+            } break;
+            }
+        }
+    }
+    out << "</svg>"sv;
 }
 
 }  // namespace svg
@@ -5,10 +5,11 @@
 #include <memory>
 #include <string>
 #include <string_view>
+#include <type_traits>
+#include <unordered_map>
 #include <vector>
 #include <optional>
 #include <variant>
-#include <map>
 
 namespace svg {
 
@@ -55,7 +56,7 @@ inline const std::string EmptyStringColor = std::string("");
 
 struct OstreamColorPrinter {
     std::ostream& out;
-    void operator()(std::string color);
+    void operator()(const std::string& color);
     void operator()(const Rgb& rgb);
     void operator()(const Rgba& rgba);
     void operator()(std::monostate) {}
@@ -88,6 +89,50 @@ struct RenderContext {
 std::ostream& operator<< (std::ostream& out, StrokeLineCap stroke_linecap);
 std::ostream& operator<< (std::ostream& out, StrokeLineJoin stroke_linejoin);
 
+// Формат вещественных чисел: decimals знаков после запятой без завершающих нулей,
+// а если decimals не задано - precision значащих цифр, как у std::ostream
+struct NumberFormat {
+    std::optional<int> decimals;
+    int precision = 6;
+};
+
+// Дописывает текст SVG в растущую строку. Числа форматируются через std::to_chars
+// без обращения к потокам и локали.
+class OutputBuffer {
+public:
+    explicit OutputBuffer(std::string& output, NumberFormat format = {});
+
+public:
+    OutputBuffer& operator<<(std::string_view text) {
+        output_.append(text);
+        return *this;
+    }
+    OutputBuffer& operator<<(const std::string& text) {
+        output_.append(text);
+        return *this;
+    }
+    OutputBuffer& operator<<(char c) {
+        output_.push_back(c);
+        return *this;
+    }
+    OutputBuffer& operator<<(uint32_t value);
+    // Координаты и размеры: в формате NumberFormat
+    OutputBuffer& operator<<(double value);
+    OutputBuffer& operator<<(const Color& color);
+    OutputBuffer& operator<<(StrokeLineCap stroke_linecap);
+    OutputBuffer& operator<<(StrokeLineJoin stroke_linejoin);
+
+    const NumberFormat& GetFormat() const;
+    std::string& GetOutput();
+
+private:
+    void WriteGeneral(double value);
+
+private:
+    std::string& output_;
+    NumberFormat format_;
+};
+
 class Object {
 public:
     virtual void Render(const RenderContext& context) const;
@@ -98,15 +143,30 @@ private:
     virtual void RenderObject(const RenderContext& context) const = 0;
 };
 
+class Circle;
+class Polyline;
+class Text;
+
 class ObjectContainer {
 public:
     template <typename Obj>
     void Add(Obj obj) {
-        AddPtr(std::make_unique<Obj>(std::move(obj)));
+        if constexpr (std::is_same_v<Obj, Circle> || std::is_same_v<Obj, Polyline> || std::is_same_v<Obj, Text>) {
+            AddObject(std::move(obj));
+        }
+        else {
+            AddPtr(std::make_unique<Obj>(std::move(obj)));
+        }
     }
 
    virtual void AddPtr(std::unique_ptr<Object>&& obj) = 0;
 
+    // Контейнер может хранить стандартные фигуры без отдельного объекта в куче.
+    // По умолчанию они передаются в AddPtr.
+    virtual void AddObject(Circle&& circle);
+    virtual void AddObject(Polyline&& polyline);
+    virtual void AddObject(Text&& text);
+
 protected:
     ~ObjectContainer() = default;
 
@@ -118,50 +178,52 @@ public:
     virtual ~Drawable() = default;
 };
 
+// Атрибуты обводки и заливки фигуры
+struct PathStyle {
+    std::optional<Color> fill_color;
+    std::optional<Color> stroke_color;
+    std::optional<double> stroke_width;
+    std::optional<StrokeLineCap> stroke_linecap;
+    std::optional<StrokeLineJoin> stroke_linejoin;
+
+    void Render(std::ostream& out) const;
+    void Render(OutputBuffer& out) const;
+};
+
+bool operator==(const PathStyle& lhs, const PathStyle& rhs);
+
+struct PathStyleHasher {
+    size_t operator()(const PathStyle& style) const;
+};
+
 template <typename Owner>
 class PathProps {
 public:
     Owner& SetFillColor(Color color) {
-        fill_color_ = std::move(color);
+        style_.fill_color = std::move(color);
         return AsOwner();
     }
     Owner& SetStrokeColor(Color color) {
-        stroke_color_ = std::move(color);
+        style_.stroke_color = std::move(color);
         return AsOwner();
     }
     Owner& SetStrokeWidth(double width) {
-        stroke_width_ = width;
+        style_.stroke_width = width;
         return AsOwner();
     }
     Owner& SetStrokeLineCap(StrokeLineCap line_cap) {
-        stroke_linecap_ = line_cap;
+        style_.stroke_linecap = line_cap;
         return AsOwner();
     }
     Owner& SetStrokeLineJoin(StrokeLineJoin line_join) {
-        stroke_linejoin_ = line_join;
+        style_.stroke_linejoin = line_join;
         return AsOwner();
     }
 protected:
     ~PathProps() = default;
 
     void RenderAttrs(std::ostream& out) const {
-        using namespace std::literals;
-
-        if (fill_color_) {
-            out << " fill=\""sv << *fill_color_ << "\""sv;
-        }
-        if (stroke_color_) {
-            out << " stroke=\""sv << *stroke_color_ << "\""sv;
-        }
-        if (stroke_width_) {
-            out << " stroke-width=\""sv << *stroke_width_ << "\""sv;
-        }
-        if (stroke_linecap_) {
-            out << " stroke-linecap=\""sv << *stroke_linecap_ << "\""sv;
-        }
-        if (stroke_linejoin_) {
-            out << " stroke-linejoin=\""sv << *stroke_linejoin_ << "\""sv;
-        }
+        style_.Render(out);
     }
 
 private:
@@ -170,11 +232,9 @@ private:
     }
 
 private:
-    std::optional<Color> fill_color_;
-    std::optional<Color> stroke_color_;
-    std::optional<double> stroke_width_;
-    std::optional<StrokeLineCap> stroke_linecap_;
-    std::optional<StrokeLineJoin> stroke_linejoin_;
+    friend class Document;
+
+    PathStyle style_;
 };
 
 class Circle final : public Object, public PathProps<Circle> {
@@ -183,6 +243,8 @@ public:
     Circle& SetRadius(double radius);
 
 private:
+    friend class Document;
+
     void RenderObject(const RenderContext& context) const override;
 
 private:
@@ -195,6 +257,8 @@ public:
     Polyline& AddPoint(const Point& point);
 
 private:
+    friend class Document;
+
     void RenderObject(const RenderContext& context) const override;
 
 private:
@@ -202,6 +266,7 @@ private:
 };
 
 void HtmlEncodeString(std::ostream& out, std::string_view sv);
+void HtmlEncodeString(std::string& out, std::string_view sv);
 
 class Text final : public Object, public PathProps<Text> {
 public:
@@ -213,6 +278,8 @@ public:
     Text& SetData(const std::string& data);
 
 private:
+    friend class Document;
+
     void RenderObject(const RenderContext& context) const override;
 
 private:
@@ -224,13 +291,81 @@ private:
     std::string data_;
 };
 
+// Circle, Polyline и Text хранятся в непрерывных массивах своего типа: точки всех
+// линий и подписи всех текстов лежат в общих буферах, одинаковые стили и шрифты
+// хранятся один раз и ссылаются по номеру. Вывод идёт без виртуальных вызовов.
+// Прочие объекты, добавленные через AddPtr, хранятся как раньше.
 class Document final : public ObjectContainer {
 public:
     void AddPtr(std::unique_ptr<Object>&& obj) override;
+    void AddObject(Circle&& circle) override;
+    void AddObject(Polyline&& polyline) override;
+    void AddObject(Text&& text) override;
+    // Числа выводятся с точностью потока out
     void Render(std::ostream& out) const;
+    // Дописывает документ в output
+    void Render(std::string& output, NumberFormat format = {}) const;
 
 private:
+    enum class Kind : uint8_t {
+        kCircle,
+        kPolyline,
+        kText,
+        kObject
+    };
+
+    // Подряд идущие объекты одного типа: порядок вывода совпадает с порядком добавления
+    struct Run {
+        Kind kind = Kind::kObject;
+        uint32_t count = 0u;
+    };
+
+    struct CircleRecord {
+        Point center;
+        double radius = 0.0;
+        uint32_t style = 0u;
+    };
+
+    struct PolylineRecord {
+        uint32_t first_point = 0u;
+        uint32_t points_count = 0u;
+        uint32_t style = 0u;
+    };
+
+    struct TextRecord {
+        Point pos;
+        Point offset;
+        uint32_t size = 0u;
+        uint32_t style = 0u;
+        uint32_t font_family = 0u;
+        uint32_t font_weight = 0u;
+        uint32_t data_begin = 0u;
+        uint32_t data_size = 0u;
+    };
+
+    void AddRun(Kind kind);
+    uint32_t InternStyle(PathStyle&& style);
+    uint32_t InternString(std::string&& value);
+
+    void RenderCircle(OutputBuffer& out, const CircleRecord& circle, std::string_view style) const;
+    void RenderPolyline(OutputBuffer& out, const PolylineRecord& polyline, std::string_view style) const;
+    void RenderText(OutputBuffer& out, const TextRecord& text, std::string_view style) const;
+
+private:
+    std::vector<Run> runs_;
+    std::vector<CircleRecord> circles_;
+    std::vector<PolylineRecord> polylines_;
+    std::vector<TextRecord> texts_;
     std::vector<std::unique_ptr<Object>> objects_;
+
+    std::vector<Point> points_;
+    // Подписи уже экранированы для XML
+    std::string text_data_;
+
+    std::vector<PathStyle> styles_;
+    std::unordered_map<PathStyle, uint32_t, PathStyleHasher> style_ids_;
+    std::vector<std::string> strings_;
+    std::unordered_map<std::string, uint32_t> string_ids_;
 };
 
 }  // namespace svg
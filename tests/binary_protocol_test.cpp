@@ -0,0 +1,133 @@
+#include "testing.h"
+
+#include "../binary_protocol.h"
+#include "../request_handler.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+using namespace std::literals;
+
+void PutU32(std::string& out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xFFu));
+    }
+}
+
+uint32_t LoadU32(std::string_view bytes) {
+    uint32_t value = 0u;
+    for (int i = 3; i >= 0; --i) {
+        value = (value << 8) | static_cast<unsigned char>(bytes[i]);
+    }
+    return value;
+}
+
+// Запрос остановки по имени
+std::string StopFrame(int id, std::string_view name) {
+    std::string payload;
+    payload.push_back(static_cast<char>(reader::QueryType::kStop));
+    PutU32(payload, static_cast<uint32_t>(id));
+    payload.push_back(static_cast<char>(binary::RefKind::kName));
+    PutU32(payload, static_cast<uint32_t>(name.size()));
+    payload.append(name);
+
+    std::string frame;
+    PutU32(frame, static_cast<uint32_t>(payload.size()));
+    return frame + payload;
+}
+
+struct Response {
+    int id = 0;
+    binary::Status status = binary::Status::kOk;
+    std::string message;
+};
+
+class BinaryServer {
+public:
+    BinaryServer()
+        : renderer_(map_render::RenderSettings{})
+        , router_(catalog_, domain::RouteSettings{})
+        , handler_(catalog_, renderer_, router_) {
+        domain::Stop stop;
+        stop.name = "A"s;
+        catalog_.AddStop(std::move(stop));
+    }
+
+    std::vector<Response> Serve(const std::string& frames) const {
+        std::istringstream input(frames);
+        std::ostringstream output;
+        handler_.ServeBinary(input, output);
+
+        std::vector<Response> responses;
+        std::istringstream answers(output.str());
+        std::string payload;
+        while (binary::ReadFrame(answers, payload)) {
+            CHECK(payload.size() >= 6u);
+            Response& response = responses.emplace_back();
+            response.id = static_cast<int>(LoadU32(std::string_view(payload).substr(1u, 4u)));
+            response.status = static_cast<binary::Status>(payload[5]);
+            if (response.status == binary::Status::kBadRequest) {
+                const uint32_t size = LoadU32(std::string_view(payload).substr(6u, 4u));
+                response.message = payload.substr(10u, size);
+            }
+        }
+        return responses;
+    }
+
+private:
+    tc::TransportCatalogue catalog_;
+    map_render::MapRender renderer_;
+    transport_router::TransportRouter router_;
+    handler::RequestHandler handler_;
+};
+
+void TestValidFrames(const BinaryServer& server) {
+    const std::vector<Response> responses = server.Serve(StopFrame(1, "A"sv) + StopFrame(2, "B"sv));
+    CHECK(responses.size() == 2u);
+    CHECK(responses[0].id == 1 && responses[0].status == binary::Status::kOk);
+    CHECK(responses[1].id == 2 && responses[1].status == binary::Status::kNotFound);
+}
+
+void TestTruncatedFrame(const BinaryServer& server) {
+    std::string frames = StopFrame(1, "A"sv);
+    // Заявлено 100 байт нагрузки, передано 3
+    PutU32(frames, 100u);
+    frames += "abc"s;
+
+    const std::vector<Response> responses = server.Serve(frames);
+    CHECK(responses.size() == 2u);
+    CHECK(responses[0].id == 1 && responses[0].status == binary::Status::kOk);
+    CHECK(responses[1].status == binary::Status::kBadRequest);
+    CHECK(responses[1].message == "Truncated frame"s);
+}
+
+void TestTruncatedHeader(const BinaryServer& server) {
+    const std::vector<Response> responses = server.Serve(StopFrame(1, "A"sv) + "\x01\x02"s);
+    CHECK(responses.size() == 2u);
+    CHECK(responses[1].status == binary::Status::kBadRequest);
+    CHECK(responses[1].message == "Truncated frame header"s);
+}
+
+void TestOversizeFrame(const BinaryServer& server) {
+    std::string frames;
+    PutU32(frames, 1u << 30);
+    // Запрос после испорченного кадра не читается: его граница неизвестна
+    frames += StopFrame(2, "A"sv);
+
+    const std::vector<Response> responses = server.Serve(frames);
+    CHECK(responses.size() == 1u);
+    CHECK(responses[0].status == binary::Status::kBadRequest);
+    CHECK(responses[0].message == "Frame is too large"s);
+}
+
+}  // namespace
+
+void TestBinaryProtocol() {
+    const BinaryServer server;
+    TestValidFrames(server);
+    TestTruncatedFrame(server);
+    TestTruncatedHeader(server);
+    TestOversizeFrame(server);
+}
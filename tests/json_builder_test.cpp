@@ -0,0 +1,38 @@
+#include "testing.h"
+
+#include "../json_builder.h"
+
+#include <stdexcept>
+
+namespace {
+using namespace std::literals;
+
+void TestDict() {
+    const json::Node node = json::Builder{}
+        .StartDict()
+            .Key("request_id"sv).Value(1)
+            .Key("stop_count"sv).Value(4)
+        .EndDict()
+        .Build();
+    const json::Dict& dict = node.AsDict();
+    CHECK(dict.size() == 2u);
+    CHECK(dict.at("request_id"sv).AsInt() == 1);
+    CHECK(dict.at("stop_count"sv).AsInt() == 4);
+}
+
+void TestDuplicateKey() {
+    CHECK_THROWS(std::logic_error, json::Builder{}
+            .StartDict()
+                .Key("request_id"sv).Value(1)
+                .Key("request_id"sv).Value(2)
+            .EndDict()
+            .Build(),
+        "Duplicate key 'request_id' have been found"sv);
+}
+
+}  // namespace
+
+void TestJsonBuilder() {
+    TestDict();
+    TestDuplicateKey();
+}
@@ -0,0 +1,88 @@
+#include "testing.h"
+
+#include "../json_lazy.h"
+#include "../json_reader.h"
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+using namespace std::literals;
+
+const std::string kDocument = R"({
+    "name": "plain", "escaped": "a\"b", "int": -7, "double": 2.5, "flag": true, "none": null,
+    "skipped": {"deep": [[1, 2], {"x": [3]}]},
+    "list": [1, "two", [3], {"four": 4}]
+})"s;
+
+void TestValues() {
+    const json::LazyDocument doc(kDocument);
+    const json::LazyDict root = doc.GetRoot().AsDict();
+    CHECK(root.size() == 8u);
+    CHECK(root.at("name"sv).AsString() == "plain"sv);
+    CHECK(root.at("escaped"sv).AsString() == "a\"b"sv);
+    CHECK(root.at("int"sv).AsInt() == -7);
+    CHECK(root.at("double"sv).AsDouble() == 2.5);
+    CHECK(root.at("flag"sv).AsBool());
+    CHECK(root.at("none"sv).IsNull());
+    CHECK(root.count("missing"sv) == 0u);
+    CHECK_THROWS(std::out_of_range, root.at("missing"sv), "Key 'missing' is not found"sv);
+
+    // Вложенный контейнер пропускается целиком
+    const json::LazyArray list = root.at("list"sv).AsArray();
+    CHECK(list.size() == 4u);
+    auto it = list.begin();
+    CHECK((*it).AsInt() == 1);
+    ++it;
+    CHECK((*it).AsString() == "two"sv);
+    ++it;
+    CHECK((*it).AsArray().size() == 1u);
+    ++it;
+    CHECK((*it).AsDict().at("four"sv).AsInt() == 4);
+    ++it;
+    CHECK(it == list.end());
+}
+
+void TestMaterialize() {
+    const json::LazyDocument doc(kDocument);
+    CHECK(doc.GetRoot().Materialize() == json::Load(kDocument).GetRoot());
+    CHECK_THROWS(json::ParsingError, json::LazyDocument("{\"a\": }"s), ""sv);
+}
+
+// Загрузка через ленту даёт те же запросы и настройки, что и разбор потока
+void TestReader() {
+    const std::string text = R"({
+        "base_requests": [
+            {"type": "Stop", "name": "A", "latitude": 55.6, "longitude": 37.2, "road_distances": {"B": 100}},
+            {"type": "Bus", "name": "1", "stops": ["A", "B"], "is_roundtrip": false},
+            {"type": "Stop", "name": "B", "latitude": 55.7, "longitude": 37.3, "road_distances": {}}
+        ],
+        "distance_settings": {"mode": "equirectangular"},
+        "stat_requests": [{"id": 1, "type": "Stop", "name": "A"}, {"id": 2, "type": "Bus", "name": "1"}]
+    })"s;
+
+    const json_reader::JSONReader lazy(json::LazyDocument{ text });
+    std::istringstream input(text);
+    const json_reader::JSONReader eager(json::Load(input));
+
+    CHECK(lazy.GetDistanceMode() == geo::DistanceMode::kEquirectangular);
+    CHECK(lazy.GetStatCommands().size() == 2u);
+    CHECK(lazy.GetStatCommands().size() == eager.GetStatCommands().size());
+    CHECK(lazy.GetStatCommands()[1].id == 2);
+
+    tc::TransportCatalogue catalog;
+    lazy.LoadDataToTC(catalog);
+    const tc::StopPtr a = catalog.GetStopByName("A"sv);
+    const tc::StopPtr b = catalog.GetStopByName("B"sv);
+    CHECK(a && b && catalog.GetStopsDistance(a, b) == 100);
+    CHECK(catalog.GetBusByName("1"sv));
+}
+
+}  // namespace
+
+void TestJsonLazy() {
+    TestValues();
+    TestMaterialize();
+    TestReader();
+}
@@ -0,0 +1,58 @@
+#include "testing.h"
+
+#include "../json_reader.h"
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+using namespace std::literals;
+
+json_reader::JSONReader MakeReader(const std::string& distance_settings) {
+    std::istringstream input(
+        R"({"base_requests": [], "stat_requests": [], "distance_settings": )"s + distance_settings + "}"s);
+    return json_reader::JSONReader(json::Load(input));
+}
+
+void TestDistanceModeDefault() {
+    CHECK(MakeReader("{}"s).GetDistanceMode() == geo::DistanceMode::kExact);
+}
+
+void TestDistanceModeKnown() {
+    CHECK(MakeReader(R"({"mode": "exact"})"s).GetDistanceMode() == geo::DistanceMode::kExact);
+    CHECK(MakeReader(R"({"mode": "equirectangular"})"s).GetDistanceMode() == geo::DistanceMode::kEquirectangular);
+}
+
+void TestDistanceModeUnknown() {
+    const json_reader::JSONReader reader = MakeReader(R"({"mode": "equirect"})"s);
+    CHECK_THROWS(std::invalid_argument, reader.GetDistanceMode(), "Unknown distance mode 'equirect'"sv);
+}
+
+void TestStatCommandErrorId() {
+    try {
+        json_reader::RequestsDecoder::DecodeStatCommand(R"({"id": 7, "type": "Bus", "name": )"sv);
+        FAIL("truncated command is decoded");
+    }
+    catch (const json_reader::StatCommandError& e) {
+        CHECK(e.GetId() == 7);
+    }
+
+    // Ошибка до разбора номера
+    try {
+        json_reader::RequestsDecoder::DecodeStatCommand(R"({"id": "7", "type": "Bus"})"sv);
+        FAIL("string id is decoded");
+    }
+    catch (const json_reader::StatCommandError& e) {
+        CHECK(!e.GetId());
+    }
+}
+
+}  // namespace
+
+void TestJsonReader() {
+    TestDistanceModeDefault();
+    TestDistanceModeKnown();
+    TestDistanceModeUnknown();
+    TestStatCommandErrorId();
+}
@@ -0,0 +1,63 @@
+#include "testing.h"
+
+#include "../json.h"
+
+#include <iterator>
+#include <sstream>
+#include <string>
+
+namespace {
+using namespace std::literals;
+
+// Данные за концом документа остаются в потоке
+void TestRestOfStreamIsKept() {
+    std::istringstream input(R"({"a": [1, 2]} {"b": 3})"s);
+    const json::Document first = json::Load(input);
+    const json::Document second = json::Load(input);
+    CHECK(first.GetRoot().AsDict().at("a"sv).AsArray().size() == 2u);
+    CHECK(second.GetRoot().AsDict().at("b"sv).AsInt() == 3);
+}
+
+void TestTrailingCommaInDict() {
+    std::istringstream input(R"({"a": 1, "b": 2,})"s);
+    CHECK(json::Load(input).GetRoot().AsDict().size() == 2u);
+}
+
+std::string MakeDict(int size, bool duplicate) {
+    std::string text = "{"s;
+    for (int i = 0; i < size; ++i) {
+        text += "\"key number "s + std::to_string(i) + "\": "s + std::to_string(i) + ", "s;
+    }
+    text += duplicate ? "\"key number 0\": 0}"s : "\"last\": -1}"s;
+    return text;
+}
+
+// Большие словари ищут ключи по индексу
+void TestLargeDict() {
+    constexpr int kSize = 1000;
+    const json::Document doc = json::Load(MakeDict(kSize, false));
+    const json::Dict& dict = doc.GetRoot().AsDict();
+    CHECK(dict.size() == kSize + 1u);
+    for (int i = 0; i < kSize; ++i) {
+        CHECK(dict.at("key number "s + std::to_string(i)).AsInt() == i);
+    }
+    CHECK(dict.count("key number 1000"sv) == 0u);
+
+    json::Dict copy = dict;
+    CHECK(copy == dict);
+    copy["added"sv] = 1;
+    CHECK(copy.at("added"sv).AsInt() == 1);
+    CHECK(copy != dict);
+    CHECK(std::prev(copy.end())->first.View() == "added"sv);
+
+    CHECK_THROWS(json::ParsingError, json::Load(MakeDict(kSize, true)),
+        "Duplicate key 'key number 0' have been found"sv);
+}
+
+}  // namespace
+
+void TestJson() {
+    TestRestOfStreamIsKept();
+    TestTrailingCommaInDict();
+    TestLargeDict();
+}
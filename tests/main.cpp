@@ -0,0 +1,41 @@
+#include "testing.h"
+
+#include <cstdlib>
+#include <iostream>
+
+namespace testing {
+namespace {
+
+int failures = 0;
+
+}  // namespace
+
+void ReportFailure(std::string_view what, const char* file, int line) {
+    ++failures;
+    std::cerr << file << ':' << line << ": check failed: " << what << '\n';
+}
+
+}  // namespace testing
+
+int main() {
+    struct Suite {
+        const char* name;
+        void (*run)();
+    };
+    const Suite suites[] = {
+        { "json", TestJson },
+        { "json_builder", TestJsonBuilder },
+        { "json_lazy", TestJsonLazy },
+        { "json_reader", TestJsonReader },
+        { "metrics", TestMetrics },
+        { "binary_protocol", TestBinaryProtocol },
+        { "pipeline", TestPipeline },
+    };
+
+    for (const Suite& suite : suites) {
+        const int before = testing::failures;
+        suite.run();
+        std::cout << suite.name << (testing::failures == before ? ": OK\n" : ": FAILED\n");
+    }
+    return testing::failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,48 @@
+#include "testing.h"
+
+#include "../metrics.h"
+
+#include <memory>
+
+namespace {
+
+// Значения 1..10 по одному разу: до 16 корзины точные
+void TestPercentileSmallValues() {
+    const auto histogram = std::make_unique<metrics::Histogram>();
+    for (uint64_t value = 1u; value <= 10u; ++value) {
+        histogram->Record(value);
+    }
+    CHECK(histogram->GetCount() == 10u);
+    CHECK(histogram->GetPercentile(0.0) == 1u);
+    CHECK(histogram->GetPercentile(10.0) == 1u);
+    CHECK(histogram->GetPercentile(50.0) == 5u);
+    CHECK(histogram->GetPercentile(90.0) == 9u);
+    CHECK(histogram->GetPercentile(95.0) == 10u);
+    CHECK(histogram->GetPercentile(100.0) == 10u);
+}
+
+// 99 быстрых запросов и один медленный: p99 ещё быстрый, выше - медленный
+void TestPercentileTail() {
+    const auto histogram = std::make_unique<metrics::Histogram>();
+    for (int i = 0; i < 99; ++i) {
+        histogram->Record(3u);
+    }
+    histogram->Record(1000u);
+    CHECK(histogram->GetPercentile(50.0) == 3u);
+    CHECK(histogram->GetPercentile(99.0) == 3u);
+    CHECK(histogram->GetPercentile(99.5) == 1000u);
+    CHECK(histogram->GetMax() == 1000u);
+}
+
+void TestPercentileEmpty() {
+    const auto histogram = std::make_unique<metrics::Histogram>();
+    CHECK(histogram->GetPercentile(50.0) == 0u);
+}
+
+}  // namespace
+
+void TestMetrics() {
+    TestPercentileSmallValues();
+    TestPercentileTail();
+    TestPercentileEmpty();
+}
@@ -0,0 +1,105 @@
+#include "testing.h"
+
+#include "../pipeline.h"
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+using namespace std::literals;
+
+void TestOrder() {
+    constexpr int kCount = 10000;
+    int next = 0;
+    std::vector<int> result;
+    // Ёмкость меньше числа заданий: исполнители упираются в окно вывода
+    pipeline::Pipeline<int, int>(4u, 8u).Run(
+        [&next](int& value) {
+            if (next == kCount) {
+                return false;
+            }
+            value = next++;
+            return true;
+        },
+        [](int value) {
+            return value * 2;
+        },
+        [&result](int& value) {
+            result.push_back(value);
+        });
+
+    CHECK(result.size() == static_cast<size_t>(kCount));
+    for (int i = 0; i < kCount; ++i) {
+        CHECK(result[i] == i * 2);
+    }
+}
+
+void TestExecuteError() {
+    int next = 0;
+    try {
+        pipeline::Pipeline<int, int>(2u).Run(
+            [&next](int& value) {
+                value = next++;
+                return true;
+            },
+            [](int value) {
+                if (value == 100) {
+                    throw std::runtime_error("execute"s);
+                }
+                return value;
+            },
+            [](int&) {
+            });
+        FAIL("error is not rethrown");
+    }
+    catch (const std::runtime_error& e) {
+        CHECK(e.what() == "execute"s);
+    }
+}
+
+// Ошибка вывода, пока source ждёт ввода, не должна ждать этого ввода
+void TestSinkErrorWithBlockedSource() {
+    auto release = std::make_shared<std::promise<void>>();
+    std::shared_future<void> released = release->get_future().share();
+    auto calls = std::make_shared<int>(0);
+
+    const auto start = std::chrono::steady_clock::now();
+    try {
+        pipeline::Pipeline<int, int>(2u).Run(
+            [released, calls](int& value) {
+                if (++*calls > 1) {
+                    released.wait();
+                    return false;
+                }
+                value = 1;
+                return true;
+            },
+            [](int value) {
+                return value;
+            },
+            [](int&) {
+                throw std::runtime_error("sink"s);
+            },
+            pipeline::SourceOnError::kDetach);
+        FAIL("error is not rethrown");
+    }
+    catch (const std::runtime_error& e) {
+        CHECK(e.what() == "sink"s);
+    }
+    CHECK(std::chrono::steady_clock::now() - start < 10s);
+
+    // Отсоединённый поток завершается, когда source вернёт управление
+    release->set_value();
+}
+
+}  // namespace
+
+void TestPipeline() {
+    TestOrder();
+    TestExecuteError();
+    TestSinkErrorWithBlockedSource();
+}
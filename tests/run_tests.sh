@@ -0,0 +1,18 @@
+#!/bin/sh
+# Собирает тесты вместе со всеми модулями, кроме main.cpp, и запускает их,
+# затем проверяет, что приложение собирается без метрик (TC_METRICS=0).
+# Запуск из любого каталога: sh tests/run_tests.sh
+set -e
+
+cd "$(dirname "$0")/.."
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--std=c++17 -O2 -pthread}
+BUILD_DIR=${BUILD_DIR:-build}
+mkdir -p "$BUILD_DIR"
+
+SOURCES=$(ls *.cpp | grep -v '^main\.cpp$')
+$CXX $CXXFLAGS -I. tests/*.cpp $SOURCES -o "$BUILD_DIR/tests"
+"$BUILD_DIR/tests"
+
+$CXX $CXXFLAGS -DTC_METRICS=0 -I. *.cpp -o "$BUILD_DIR/transport_catalogue_no_metrics"
+echo "TC_METRICS=0 build: OK"
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <string_view>
+
+// Проверки для общего тестового бинарника (tests/run_tests.sh). В отличие от
+// assert работают и с NDEBUG, а провал не останавливает остальные проверки.
+namespace testing {
+
+void ReportFailure(std::string_view what, const char* file, int line);
+
+template <typename Exception, typename Func>
+void CheckThrows(Func func, std::string_view message, const char* expr, const char* file, int line) {
+    try {
+        func();
+    }
+    catch (const Exception& e) {
+        if (!message.empty() && e.what() != message) {
+            ReportFailure(std::string(expr) + " threw '" + e.what() + "'", file, line);
+        }
+        return;
+    }
+    ReportFailure(std::string(expr) + " did not throw", file, line);
+}
+
+}  // namespace testing
+
+#define CHECK(expr) \
+    ((expr) ? void() : testing::ReportFailure(#expr, __FILE__, __LINE__))
+
+#define FAIL(what) testing::ReportFailure(what, __FILE__, __LINE__)
+
+// message - ожидаемый what(), пустой - любой
+#define CHECK_THROWS(Exception, expr, message) \
+    testing::CheckThrows<Exception>([&] { (void)(expr); }, message, #expr, __FILE__, __LINE__)
+
+// Наборы проверок, по одному на файл tests/*_test.cpp
+void TestJson();
+void TestJsonBuilder();
+void TestJsonLazy();
+void TestJsonReader();
+void TestMetrics();
+void TestBinaryProtocol();
+void TestPipeline();
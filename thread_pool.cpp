@@ -0,0 +1,135 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace thread_pool {
+
+ThreadPool::ThreadPool(size_t threads_count)
+    : queues_(threads_count ? threads_count : std::max(1u, std::thread::hardware_concurrency())) {
+    // Участник 0 - поток, вызвавший ForEach
+    workers_.reserve(queues_.size() - 1u);
+    for (size_t slot = 1u; slot < queues_.size(); ++slot) {
+        workers_.emplace_back([this, slot] {
+            WorkerLoop(slot);
+        });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+size_t ThreadPool::GetThreadsCount() const {
+    return queues_.size();
+}
+
+void ThreadPool::ForEach(size_t tasks_count, const std::function<void(size_t)>& task) {
+    if (workers_.empty() || tasks_count <= 1u) {
+        for (size_t i = 0u; i < tasks_count; ++i) {
+            task(i);
+        }
+        return;
+    }
+
+    std::lock_guard run_lock(run_mutex_);
+    job_ = &task;
+    error_ = nullptr;
+    remaining_.store(tasks_count);
+
+    // Соседние задачи попадают в одну очередь: владелец идёт по ним подряд
+    for (size_t slot = 0u; slot < queues_.size(); ++slot) {
+        const size_t begin = tasks_count * slot / queues_.size();
+        const size_t end = tasks_count * (slot + 1u) / queues_.size();
+        std::lock_guard lock(queues_[slot].mutex);
+        for (size_t i = begin; i < end; ++i) {
+            queues_[slot].tasks.push_back(i);
+        }
+    }
+
+    {
+        std::lock_guard lock(mutex_);
+        ++generation_;
+    }
+    wake_.notify_all();
+
+    Participate(0u);
+
+    std::unique_lock lock(done_mutex_);
+    done_.wait(lock, [this] { return remaining_.load() == 0u; });
+    job_ = nullptr;
+    if (error_) {
+        std::rethrow_exception(std::exchange(error_, nullptr));
+    }
+}
+
+void ThreadPool::WorkerLoop(size_t slot) {
+    uint64_t seen = 0u;
+    while (true) {
+        {
+            std::unique_lock lock(mutex_);
+            wake_.wait(lock, [this, seen] { return stop_ || generation_ != seen; });
+            if (stop_) {
+                return;
+            }
+            seen = generation_;
+        }
+        Participate(slot);
+    }
+}
+
+void ThreadPool::Participate(size_t slot) {
+    while (std::optional<size_t> task = Take(slot)) {
+        Execute(*task);
+    }
+}
+
+std::optional<size_t> ThreadPool::Take(size_t slot) {
+    {
+        WorkQueue& own = queues_[slot];
+        std::lock_guard lock(own.mutex);
+        if (!own.tasks.empty()) {
+            const size_t task = own.tasks.front();
+            own.tasks.pop_front();
+            return task;
+        }
+    }
+
+    for (size_t i = 1u; i < queues_.size(); ++i) {
+        WorkQueue& victim = queues_[(slot + i) % queues_.size()];
+        std::lock_guard lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            const size_t task = victim.tasks.back();
+            victim.tasks.pop_back();
+            return task;
+        }
+    }
+
+    return std::nullopt;
+}
+
+void ThreadPool::Execute(size_t task) {
+    try {
+        (*job_)(task);
+    }
+    catch (...) {
+        std::lock_guard lock(done_mutex_);
+        if (!error_) {
+            error_ = std::current_exception();
+        }
+    }
+
+    if (remaining_.fetch_sub(1u) == 1u) {
+        std::lock_guard lock(done_mutex_);
+        done_.notify_all();
+    }
+}
+
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace thread_pool {
+
+// Пул потоков с перехватом работы (work stealing). У каждого участника своя
+// очередь задач: он берёт задачи из её начала, а освободившись, забирает
+// задачи с конца чужих очередей. Вызывающий ForEach поток тоже участвует.
+class ThreadPool {
+public:
+    // threads_count - число участников вместе с вызывающим потоком,
+    // 0 означает число аппаратных потоков
+    explicit ThreadPool(size_t threads_count = 0u);
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ~ThreadPool();
+
+public:
+    size_t GetThreadsCount() const;
+
+    // Выполняет task(i) для всех i из [0, tasks_count) и ждёт завершения.
+    // Первое выброшенное задачей исключение передаётся вызывающему.
+    void ForEach(size_t tasks_count, const std::function<void(size_t)>& task);
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+
+    void WorkerLoop(size_t slot);
+    void Participate(size_t slot);
+    std::optional<size_t> Take(size_t slot);
+    void Execute(size_t task);
+
+private:
+    std::vector<WorkQueue> queues_;
+    std::vector<std::thread> workers_;
+
+    // ForEach выполняется не более чем одним потоком одновременно
+    std::mutex run_mutex_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    uint64_t generation_ = 0u;
+    bool stop_ = false;
+
+    // Текущее задание. Читается только после взятия задачи из очереди,
+    // пока задание заведомо не завершено.
+    const std::function<void(size_t)>* job_ = nullptr;
+    std::atomic<size_t> remaining_{ 0u };
+    std::mutex done_mutex_;
+    std::condition_variable done_;
+    std::exception_ptr error_;
+};
+
+}
@@ -3,21 +3,33 @@
 namespace tc {
 
 StopPtr TransportCatalogue::AddStop(Stop stop) {
+    stop.position_trig = geo::CoordinatesTrig(stop.position);
+    stop.id = static_cast<uint32_t>(stops_.size());
     const auto& ref = stops_.emplace_back(std::move(stop));
     names_to_stops_[ref.name] = &ref;
     bus_by_stop_[&ref];
+    ++version_;
     return &ref;
 }
 
 BusPtr TransportCatalogue::AddBus(Bus bus) {
+    bus.id = static_cast<uint32_t>(buses_.size());
     const auto& ref = buses_.emplace_back(std::move(bus));
+
+    geo::CoordinatesArray& positions = bus_positions_.emplace_back();
+    positions.Reserve(ref.stops.size());
+    for (StopPtr stop : ref.stops) {
+        positions.PushBack(stop->position, stop->position_trig.cos_lat);
+    }
     names_to_buses_[ref.name] = &ref;
+    ++version_;
     return &ref;
 }
 
 void TransportCatalogue::AddStopsDistance(StopPtr start, const std::pair<std::string_view, int>& end) {
     StopPtr end_stop = GetStopByName(end.first);
     distances_[{ start, end_stop }] = end.second;
+    ++version_;
 }
 
 int TransportCatalogue::GetStopsDistance(StopPtr start, StopPtr end) const {
@@ -45,11 +57,20 @@ StopPtr TransportCatalogue::GetStopByName(std::string_view name) const {
     return nullptr;
 }
 
+StopPtr TransportCatalogue::GetStopById(uint32_t id) const {
+    return id < stops_.size() ? &stops_[id] : nullptr;
+}
+
+BusPtr TransportCatalogue::GetBusById(uint32_t id) const {
+    return id < buses_.size() ? &buses_[id] : nullptr;
+}
+
 void TransportCatalogue::AddStopsToBus(BusPtr bus,
     std::vector<StopPtr>::const_iterator first, std::vector<StopPtr>::const_iterator last) {
     for (auto it = first; it != last; ++it) {
         bus_by_stop_[*it].insert(bus);
     }
+    ++version_;
 }
 
 BusPtr TransportCatalogue::GetBusByName(std::string_view name) const {
@@ -81,10 +102,19 @@ StopStat TransportCatalogue::GetBusesForStop(std::string_view stop_name) const {
 BusStat TransportCatalogue::GetStat(BusPtr bus) const {
     BusStat result;
 
+    if (distance_mode_ == geo::DistanceMode::kExact) {
+        result.curvature = geo::ComputePathLength(bus_positions_[bus->id]);
+    }
+    else {
+        for (size_t i = 1; i < bus->stops.size(); ++i) {
+            result.curvature += geo::ComputeDistance(
+                bus->stops[i - 1]->position_trig, bus->stops[i]->position_trig, distance_mode_);
+        }
+    }
+
     StopPtr last_stop = bus->stops[0];
     for (size_t i = 1; i < bus->stops.size(); ++i) {
         StopPtr stop = bus->stops[i];
-        result.curvature += geo::ComputeDistance(last_stop->position, stop->position);
         result.route_length += GetStopsDistance(last_stop, stop);
         last_stop = stop;
     }
@@ -92,10 +122,11 @@ BusStat TransportCatalogue::GetStat(BusPtr bus) const {
     if (!bus->is_roundtrip) {
         for (size_t i = bus->stops.size() - 1; i-- > 0u;) {
             StopPtr stop = bus->stops[i];
-            result.curvature += geo::ComputeDistance(last_stop->position, stop->position);
             result.route_length += GetStopsDistance(last_stop, stop);
             last_stop = stop;
         }
+        // Расстояние по прямой симметрично, обратный путь равен прямому
+        result.curvature *= 2;
         result.stops_count = bus->stops.size() * 2 - 1;
     }
     else {
@@ -126,6 +157,15 @@ std::vector<StopPtr> TransportCatalogue::GetStopsWithRoutes() const {
     return result;
 }
 
+void TransportCatalogue::SetDistanceMode(geo::DistanceMode mode) {
+    distance_mode_ = mode;
+    ++version_;
+}
+
+uint64_t TransportCatalogue::GetVersion() const {
+    return version_;
+}
+
 const std::unordered_map<std::string_view, StopPtr>& TransportCatalogue::GetNamesToStops() const {
     return names_to_stops_;
 }
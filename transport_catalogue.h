@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <deque>
 #include <set>
 #include <string_view>
@@ -20,6 +21,9 @@ public:
     void AddStopsDistance(StopPtr start, const std::pair<std::string_view, int>& end);
     int GetStopsDistance(StopPtr start, StopPtr end) const;
     StopPtr GetStopByName(std::string_view name) const;
+    // Номера остановок и автобусов совпадают с порядком добавления
+    StopPtr GetStopById(uint32_t id) const;
+    BusPtr GetBusById(uint32_t id) const;
     void AddStopsToBus(BusPtr bus,
         std::vector<StopPtr>::const_iterator first, std::vector<StopPtr>::const_iterator last);
 
@@ -28,6 +32,10 @@ public:
     BusStat GetStat(BusPtr bus) const;
     std::vector<BusPtr> GetBuses() const;
     std::vector<StopPtr> GetStopsWithRoutes() const;
+    void SetDistanceMode(geo::DistanceMode mode);
+    // Растёт при каждом изменении справочника. Позволяет сбрасывать кэши,
+    // построенные по его содержимому.
+    uint64_t GetVersion() const;
 
     const std::unordered_map<std::string_view, StopPtr>& GetNamesToStops() const;
     const std::unordered_map<std::string_view, BusPtr>& GetNamesToBuses() const;
@@ -39,5 +47,9 @@ private:
     std::unordered_map<std::string_view, StopPtr> names_to_stops_;
     std::unordered_map<std::string_view, BusPtr> names_to_buses_;
     std::unordered_map<std::pair<StopPtr, StopPtr>, int, detail::PairHasher> distances_;
+    // Координаты остановок каждого автобуса (по номеру) для пакетного расчёта длины пути
+    std::vector<geo::CoordinatesArray> bus_positions_;
+    geo::DistanceMode distance_mode_ = geo::DistanceMode::kExact;
+    uint64_t version_ = 0u;
 };
 }
\ No newline at end of file
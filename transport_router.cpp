@@ -1,20 +1,33 @@
 #include "transport_router.h"
+#include "metrics.h"
 
 namespace transport_router {
 
 TransportRouter::TransportRouter(const tc::TransportCatalogue& catalog, domain::RouteSettings settings)
-	: graph_(catalog.GetNamesToStops().size() * 2u)
+	: catalog_(catalog)
 	, settings_(settings) {
+}
 
-	BuildGraph(catalog);
-	router_ = std::make_unique<graph::Router<double>>(graph_);
+void TransportRouter::Build() const {
+	// Параллельные запросы ждут, пока первый из них построит таблицу
+	std::call_once(built_, [this] {
+		metrics::ScopedTimer timer(metrics::Timer::kBuildRouter);
+		graph_ = graph::DirectedWeightedGraph<double>(catalog_.GetNamesToStops().size() * 2u);
+		BuildGraph(catalog_);
+		router_ = std::make_unique<graph::Router<double>>(graph_);
+	});
 }
 
 std::optional<domain::TRouteStat> TransportRouter::GetRoute(std::string_view from, std::string_view to) const {
-	auto from_id = stop_to_stop_ids_.at(from).transfer_id;
-	auto to_id = stop_to_stop_ids_.at(to).transfer_id;
+	Build();
+	// Неизвестная остановка - маршрут не найден, как и для несвязанных остановок
+	const auto from_it = stop_to_stop_ids_.find(from);
+	const auto to_it = stop_to_stop_ids_.find(to);
+	if (from_it == stop_to_stop_ids_.end() || to_it == stop_to_stop_ids_.end()) {
+		return std::nullopt;
+	}
 
-	auto route = router_->BuildRoute(from_id, to_id);
+	auto route = router_->BuildRoute(from_it->second.transfer_id, to_it->second.transfer_id);
 
 	if (route) {
 		domain::TRouteStat data;
@@ -38,7 +51,7 @@ domain::TRouteItemStat TransportRouter::TGraphDataToStat(const TGraphData& data)
 	return { domain::TRouteType::kWait, data.from, data.span_count, data.time };
 }
 
-void TransportRouter::AddStops(const std::unordered_map<std::string_view, domain::StopPtr>& stops) {
+void TransportRouter::AddStops(const std::unordered_map<std::string_view, domain::StopPtr>& stops) const {
 	graph::VertexId i = 0u;
 
 	for (const auto& [_, stop] : stops) {
@@ -50,7 +63,7 @@ void TransportRouter::AddStops(const std::unordered_map<std::string_view, domain
 	}
 }
 
-void TransportRouter::BuildGraph(const tc::TransportCatalogue& catalog) {
+void TransportRouter::BuildGraph(const tc::TransportCatalogue& catalog) const {
 	AddStops(catalog.GetNamesToStops());
 
 	for (const auto& [_, bus_ptr] : catalog.GetNamesToBuses()) {
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 
 #include "transport_catalogue.h"
 #include "router.h"
@@ -20,20 +21,25 @@ struct TGraphData {
 	double time = 0.0;
 };
 
+// Граф и таблица маршрутов между всеми парами остановок строятся при первом
+// запросе маршрута по состоянию справочника на этот момент. Пакеты без запросов
+// Route не платят за предрасчёт.
 class TransportRouter {
 public:
 	TransportRouter(const tc::TransportCatalogue& catalog, domain::RouteSettings settings);
 
 public:
 	std::optional<domain::TRouteStat> GetRoute(std::string_view from, std::string_view to) const;
+	// Строит граф и таблицу маршрутов заранее, если это ещё не сделано
+	void Build() const;
 
 private:
 	domain::TRouteItemStat TGraphDataToStat(const TGraphData& data) const;
-	void AddStops(const std::unordered_map<std::string_view, domain::StopPtr>& stops);
-	void BuildGraph(const tc::TransportCatalogue& catalog);
+	void AddStops(const std::unordered_map<std::string_view, domain::StopPtr>& stops) const;
+	void BuildGraph(const tc::TransportCatalogue& catalog) const;
 
 	template <typename Iter>
-	void AddEdgesFromBusRoute(std::string_view bus, Iter first, Iter last, const tc::TransportCatalogue& catalog) {
+	void AddEdgesFromBusRoute(std::string_view bus, Iter first, Iter last, const tc::TransportCatalogue& catalog) const {
 		if (first == last) return;
 		for (auto it_from = first; it_from != last; ++it_from) {
 			domain::StopPtr last_stop = *it_from;
@@ -68,11 +74,14 @@ private:
 	}
 
 private:
-	graph::DirectedWeightedGraph<double> graph_;
+	const tc::TransportCatalogue& catalog_;
 	domain::RouteSettings settings_;
-	std::unique_ptr<graph::Router<double>> router_;
-	std::unordered_map<graph::EdgeId, TGraphData> edge_to_data_;
-	std::unordered_map<std::string_view, StopIds> stop_to_stop_ids_;
+
+	mutable std::once_flag built_;
+	mutable graph::DirectedWeightedGraph<double> graph_;
+	mutable std::unique_ptr<graph::Router<double>> router_;
+	mutable std::unordered_map<graph::EdgeId, TGraphData> edge_to_data_;
+	mutable std::unordered_map<std::string_view, StopIds> stop_to_stop_ids_;
 };
 
 }
\ No newline at end of file